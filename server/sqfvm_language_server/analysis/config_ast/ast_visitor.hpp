@@ -19,11 +19,18 @@ namespace sqfvm::language_server::analysis::config_ast {
             database::tables::t_code_action code_action;
             std::vector<database::tables::t_code_action_change> changes;
         };
+        struct hover_tuple {
+            database::tables::t_hover hover;
+            std::string markdown;
+        };
         std::vector<database::tables::t_reference> m_references;
         std::vector<database::tables::t_variable> m_variables;
         std::vector<database::tables::t_diagnostic> m_diagnostics;
-        std::vector<database::tables::t_hover> m_hovers;
+        std::vector<hover_tuple> m_hovers;
         std::vector<code_action_tuple> m_code_actions;
+        std::vector<database::tables::t_config_class> m_config_classes;
+        std::vector<database::tables::t_config_property> m_config_properties;
+        std::vector<database::tables::t_config_function> m_config_functions;
 
         friend class config_ast_analyzer;
 
@@ -62,6 +69,10 @@ namespace sqfvm::language_server::analysis::config_ast {
             return a.scope_name();
         }
 
+        uint64_t file_id_of(config_ast_analyzer &a, const sqf::parser::config::bison::astnode &node) const {
+            return a.file_id_of(node);
+        }
+
         [[nodiscard]] bool is_private_variable(std::string_view name) const {
             return name.empty() ? false : name[0] == '_';
         }
@@ -5,9 +5,11 @@
 #include "config_ast_analyzer.hpp"
 
 #include "ast_visitor.hpp"
+#include "../../database/row_diff.hpp"
 #include "visitors/general_visitor.hpp"
 #include <utility>
 #include <unordered_map>
+#include <unordered_set>
 #include <fileio/default.h>
 #include <parser/preprocessor/default.h>
 #include <parser/config/config_parser.hpp>
@@ -53,36 +55,24 @@ void sqfvm::language_server::analysis::config_ast::config_ast_analyzer::commit()
         }
 
 #pragma region Code Actions
-        // Remove old code actions
-        for (auto &it: storage.get_all<database::tables::t_code_action>(
-                where(c(&database::tables::t_code_action::file_fk) == m_file.id_pk))) {
-            storage.remove_all<database::tables::t_code_action_change>(
-                    where(c(&database::tables::t_code_action_change::code_action_fk) == it.id_pk));
-        }
-        storage.remove_all<database::tables::t_code_action>(
-                where(c(&database::tables::t_code_action::file_fk) == m_file.id_pk));
-
-        // Add new code actions
+        std::vector<std::pair<database::tables::t_code_action, std::vector<database::tables::t_code_action_change>>> code_actions;
         for (auto &visitor: m_visitors) {
             for (auto &it: visitor->m_code_actions) {
                 if (it.code_action.file_fk == 0)
                     it.code_action.file_fk = m_file.id_pk;
-                auto code_action_id = storage.insert(it.code_action);
-                for (auto &change: it.changes) {
-                    change.code_action_fk = code_action_id;
-                }
-                storage.insert_range(it.changes.begin(), it.changes.end());
+                code_actions.emplace_back(it.code_action, it.changes);
             }
         }
+        database::apply_code_action_diff(storage, m_file.id_pk, code_actions);
 #pragma endregion
 #pragma region Hovers
         if (!m_preprocessed_text.empty()) {
-            // Remove old hovers
-            storage.remove_all<database::tables::t_hover>(
+            auto db_hovers = storage.get_all<database::tables::t_hover>(
                     where(c(&database::tables::t_hover::file_fk) == m_file.id_pk));
 
-            // Add new hovers
+            // Collect new hovers
             std::vector<database::tables::t_hover> hovers;
+            std::vector<std::string> markdowns;
             std::stringstream hover_text;
             for (auto &it: m_hover_tuples) {
                 if (std::filesystem::path(it.path) != m_file.path)
@@ -101,26 +91,41 @@ void sqfvm::language_server::analysis::config_ast::config_ast_analyzer::commit()
                         it.start_column,
                         it.end_line,
                         it.end_column,
-                        hover_text.str());
+                        0);
+                markdowns.push_back(hover_text.str());
                 hover_text.str("");
             }
-            storage.insert_range(hovers.begin(), hovers.end());
             for (auto &visitor: m_visitors) {
                 for (auto &it: visitor->m_hovers) {
-                    if (it.file_fk == 0)
-                        it.file_fk = m_file.id_pk;
+                    if (it.hover.file_fk == 0)
+                        it.hover.file_fk = m_file.id_pk;
+                    hovers.push_back(it.hover);
+                    markdowns.push_back(it.markdown);
                 }
-                storage.insert_range(visitor->m_hovers.begin(), visitor->m_hovers.end());
             }
+
+            // Store each distinct markdown once
+            auto content_ids = database::intern_hover_contents(storage, markdowns);
+            for (size_t i = 0; i < hovers.size(); i++) {
+                hovers[i].content_fk = content_ids[i];
+            }
+            std::unordered_set<uint64_t> stale_content_ids;
+            for (const auto &it: db_hovers) {
+                stale_content_ids.insert(it.content_fk);
+            }
+            for (auto content_id: content_ids) {
+                stale_content_ids.erase(content_id);
+            }
+            database::apply_diff(storage, db_hovers, hovers);
+            database::remove_unreferenced_hover_contents(storage, stale_content_ids);
         }
 #pragma endregion
 #pragma region Includes
         if (!m_preprocessed_text.empty()) {
-            // Remove old includes
-            storage.remove_all<database::tables::t_file_include>(
+            auto db_file_includes = storage.get_all<database::tables::t_file_include>(
                     where(c(&database::tables::t_file_include::source_file_fk) == m_file.id_pk));
 
-            // Add new includes
+            // Collect new includes
             std::vector<database::tables::t_file_include> file_includes;
             for (auto &it: m_file_include) {
                 auto included_path_file = m_context.db_get_file_from_path(it.included_path);
@@ -135,15 +140,59 @@ void sqfvm::language_server::analysis::config_ast::config_ast_analyzer::commit()
                         source_path_file->id_pk,
                         m_file.id_pk);
             }
-            storage.insert_range(file_includes.begin(), file_includes.end());
+            database::apply_diff(storage, db_file_includes, file_includes);
+        }
+#pragma endregion
+#pragma region Config classes
+        {
+            auto db_classes = storage.get_all<database::tables::t_config_class>(
+                    where(c(&database::tables::t_config_class::source_file_fk) == m_file.id_pk));
+            auto db_properties = storage.get_all<database::tables::t_config_property>(
+                    where(c(&database::tables::t_config_property::source_file_fk) == m_file.id_pk));
+
+            std::vector<database::tables::t_config_class> classes;
+            std::vector<database::tables::t_config_property> properties;
+            for (auto &visitor: m_visitors) {
+                for (auto &it: visitor->m_config_classes) {
+                    if (it.file_fk == 0)
+                        it.file_fk = m_file.id_pk;
+                    it.source_file_fk = m_file.id_pk;
+                    classes.push_back(it);
+                }
+                for (auto &it: visitor->m_config_properties) {
+                    if (it.file_fk == 0)
+                        it.file_fk = m_file.id_pk;
+                    it.source_file_fk = m_file.id_pk;
+                    properties.push_back(it);
+                }
+            }
+            database::apply_diff(storage, db_classes, classes);
+            database::apply_diff(storage, db_properties, properties);
+        }
+#pragma endregion
+#pragma region Config functions
+        {
+            auto db_functions = storage.get_all<database::tables::t_config_function>(
+                    where(c(&database::tables::t_config_function::source_file_fk) == m_file.id_pk));
+
+            std::vector<database::tables::t_config_function> functions;
+            for (auto &visitor: m_visitors) {
+                for (auto &it: visitor->m_config_functions) {
+                    if (it.file_fk == 0)
+                        it.file_fk = m_file.id_pk;
+                    it.source_file_fk = m_file.id_pk;
+                    functions.push_back(it);
+                }
+            }
+            database::apply_diff(storage, db_functions, functions);
         }
 #pragma endregion
 #pragma region Diagnostics
-        // Remove old diagnostics
-        storage.remove_all<database::tables::t_diagnostic>(
+        auto db_diagnostics = storage.get_all<database::tables::t_diagnostic>(
                 where(c(&database::tables::t_diagnostic::source_file_fk) == m_file.id_pk));
 
-        // Add new diagnostics
+        // Collect new diagnostics
+        std::vector<database::tables::t_diagnostic> diagnostics;
         for (auto &it: m_diagnostics) {
             if (it.file_fk == 0)
                 it.file_fk = m_file.id_pk;
@@ -153,8 +202,8 @@ void sqfvm::language_server::analysis::config_ast::config_ast_analyzer::commit()
                                ? m_file.path
                                : m_context.storage().get<database::tables::t_file>(it.file_fk).path;
             it.is_suppressed = !m_slspp_context->can_report(it.code, path, it.line);
+            diagnostics.push_back(it);
         }
-        storage.insert_range(m_diagnostics.begin(), m_diagnostics.end());
         for (auto &visitor: m_visitors) {
             for (auto &it: visitor->m_diagnostics) {
                 if (it.file_fk == 0)
@@ -165,9 +214,10 @@ void sqfvm::language_server::analysis::config_ast::config_ast_analyzer::commit()
                                    ? m_file.path
                                    : m_context.storage().get<database::tables::t_file>(it.file_fk).path;
                 it.is_suppressed = !m_slspp_context->can_report(it.code, path, it.line);
+                diagnostics.push_back(it);
             }
-            storage.insert_range(visitor->m_diagnostics.begin(), visitor->m_diagnostics.end());
         }
+        database::apply_diff(storage, db_diagnostics, diagnostics);
 #pragma endregion
 
         // Remove outdated flag
@@ -188,25 +238,49 @@ void sqfvm::language_server::analysis::config_ast::config_ast_analyzer::commit()
 
 }
 
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "misc-no-recursion"
+void sqfvm::language_server::analysis::config_ast::config_ast_analyzer::traverse(
+        const sqf::parser::config::bison::astnode &root) {
+    // The index of the next child to visit of every node in m_descend_ast_nodes
+    std::vector<size_t> next_children;
+    auto enter = [&](const sqf::parser::config::bison::astnode &node) {
+        for (auto &visitor: m_visitors) {
+            visitor->enter(*this, node, m_descend_ast_nodes);
+        }
+        m_descend_ast_nodes.push_back(&node);
+        next_children.push_back(0);
+    };
 
-void sqfvm::language_server::analysis::config_ast::config_ast_analyzer::recurse(
-        const sqf::parser::config::bison::astnode &parent) {
-    for (auto &visitor: m_visitors) {
-        visitor->enter(*this, parent, m_descend_ast_nodes);
-    }
-    m_descend_ast_nodes.push_back(&parent);
-    for (auto &child: parent.children) {
-        recurse(child);
-    }
-    m_descend_ast_nodes.pop_back();
-    for (auto &visitor: m_visitors) {
-        visitor->exit(*this, parent, m_descend_ast_nodes);
+    enter(root);
+    while (!next_children.empty()) {
+        const auto &node = *m_descend_ast_nodes.back();
+        auto &next_child = next_children.back();
+        if (next_child < node.children.size()) {
+            enter(node.children[next_child++]);
+            continue;
+        }
+        next_children.pop_back();
+        m_descend_ast_nodes.pop_back();
+        for (auto &visitor: m_visitors) {
+            visitor->exit(*this, node, m_descend_ast_nodes);
+        }
     }
 }
 
-#pragma clang diagnostic pop
+uint64_t sqfvm::language_server::analysis::config_ast::config_ast_analyzer::file_id_of(
+        const sqf::parser::config::bison::astnode &node) {
+    if (!node.token.path || node.token.path->empty())
+        return m_file.id_pk;
+    auto node_path = std::filesystem::path(*node.token.path).lexically_normal().string();
+    if (node_path == m_file.path)
+        return m_file.id_pk;
+    auto it = m_file_ids_by_path.find(node_path);
+    if (it != m_file_ids_by_path.end())
+        return it->second;
+    auto file = m_context.db_get_file_from_path(node_path, true);
+    auto file_id = file.has_value() ? file->id_pk : m_file.id_pk;
+    m_file_ids_by_path.emplace(node_path, file_id);
+    return file_id;
+}
 
 void sqfvm::language_server::analysis::config_ast::config_ast_analyzer::analyze(sqf::runtime::runtime &runtime) {
     for (auto &visitor: m_visitors) {
@@ -214,13 +288,11 @@ void sqfvm::language_server::analysis::config_ast::config_ast_analyzer::analyze(
     }
     auto parser = sqf::parser::config::parser(runtime.get_logger());
     auto tokenizer = sqf::parser::config::tokenizer(m_preprocessed_text.begin(), m_preprocessed_text.end(), m_file.path);
-    // sqf::parser::config::bison::astnode root;
-    // auto success = parser.get_tree(runtime, tokenizer, &root);
-    // if (!success) {
-    //     return;
-    // }
-    // recurse(root);
-    parser.parse(runtime.confighost(), m_preprocessed_text, {m_file.path, {}, {}});
+    sqf::parser::config::bison::astnode root;
+    auto success = parser.get_tree(runtime, tokenizer, &root);
+    if (success) {
+        traverse(root);
+    }
     for (auto &visitor: m_visitors) {
         visitor->end(*this);
     }
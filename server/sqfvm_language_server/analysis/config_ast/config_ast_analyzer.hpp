@@ -8,7 +8,9 @@
 #include "../slspp_context.hpp"
 #include "../sqfvm_analyzer.hpp"
 #include "../../sqfvm_factory.hpp"
+#include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 
 namespace sqf::parser::config::bison
@@ -56,7 +58,14 @@ namespace sqfvm::language_server::analysis::config_ast {
         std::vector<const ::sqf::parser::config::bison::astnode *> m_descend_ast_nodes;
         std::filesystem::path m_ls_path;
 
-        void recurse(const sqf::parser::config::bison::astnode &parent);
+        // File ids by lexically normal path of all files nodes originated from during this analysis.
+        std::unordered_map<std::string, uint64_t> m_file_ids_by_path;
+
+        // Returns the id of the file the given node originates from, creating the file if it is unknown.
+        [[nodiscard]] uint64_t file_id_of(const sqf::parser::config::bison::astnode &node);
+
+        // Walks the given node and all of its children depth-first using an explicit stack.
+        void traverse(const sqf::parser::config::bison::astnode &root);
 
         [[nodiscard]] std::string scope_name() const {
             std::string scope{};
@@ -1,7 +1,121 @@
 #include "general_visitor.hpp"
+#include "parser/config/parser.tab.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+#define LINE_OFFSET -1
 
 using namespace sqfvm::language_server::database::tables;
 using namespace std::string_view_literals;
+using sqf::parser::config::bison::astkind;
+using sqf::parser::config::bison::astnode;
+
+namespace {
+    // Upper bound of inheritance chains followed, guarding against cyclic inheritance.
+    const size_t max_inheritance_depth = 64;
+
+    std::string fold_case(std::string_view name) {
+        std::string folded(name);
+        std::transform(folded.begin(), folded.end(), folded.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        return folded;
+    }
+
+    std::string join_path(std::string_view parent_path, std::string_view folded_name) {
+        std::string path;
+        path.reserve(parent_path.size() + 1 + folded_name.size());
+        if (!parent_path.empty()) {
+            path.append(parent_path);
+            path.push_back('/');
+        }
+        path.append(folded_name);
+        return path;
+    }
+
+    std::string parent_path_of(std::string_view path) {
+        auto slash = path.rfind('/');
+        return slash == std::string_view::npos ? std::string{} : std::string(path.substr(0, slash));
+    }
+
+    bool is_class(const astnode &node) {
+        return node.kind == astkind::CONFIGNODE || node.kind == astkind::CONFIGNODE_PARENT;
+    }
+
+    bool is_property(const astnode &node) {
+        return node.kind == astkind::VALUENODE || node.kind == astkind::VALUENODE_ADDARRAY;
+    }
+
+    // Strips the quotes of a string literal, collapsing doubled quotes.
+    std::string unquote(std::string_view contents) {
+        if (contents.size() < 2 || (contents.front() != '"' && contents.front() != '\'')
+            || contents.back() != contents.front())
+            return std::string(contents);
+        auto quote = contents.front();
+        contents = contents.substr(1, contents.size() - 2);
+        std::string result;
+        result.reserve(contents.size());
+        for (size_t i = 0; i < contents.size(); i++) {
+            result.push_back(contents[i]);
+            if (contents[i] == quote && i + 1 < contents.size() && contents[i + 1] == quote)
+                i++;
+        }
+        return result;
+    }
+
+    // Returns the value of a property as text, see t_config_property::value.
+    std::string value_of(const astnode &value) {
+        // Arrays are walked with an explicit stack, as they may be nested arbitrarily deep.
+        struct frame {
+            const astnode *node;
+            size_t next_child;
+        };
+        std::string result;
+        std::vector<frame> stack{{&value, 0}};
+        while (!stack.empty()) {
+            auto &top = stack.back();
+            if (top.node->kind != astkind::ARRAY) {
+                result.append(top.node->kind == astkind::STRING
+                              ? unquote(top.node->token.contents)
+                              : top.node->token.contents);
+                stack.pop_back();
+                continue;
+            }
+            if (top.next_child == 0)
+                result.push_back('{');
+            if (top.next_child == top.node->children.size()) {
+                result.push_back('}');
+                stack.pop_back();
+                continue;
+            }
+            if (top.next_child > 0)
+                result.append(", "sv);
+            auto child = &top.node->children[top.next_child++];
+            stack.push_back({child, 0});
+        }
+        return result;
+    }
+
+    t_diagnostic diag_undefined_base_class_001(
+            uint64_t self_file_id,
+            const t_config_class &config_class) {
+        return {
+                .id_pk = {},
+                .file_fk = config_class.file_fk,
+                .source_file_fk = self_file_id,
+                .line = config_class.base_line + LINE_OFFSET,
+                .column = config_class.base_column,
+                .offset = 0,
+                .length = config_class.base_name.length(),
+                .severity = t_diagnostic::warning,
+                .message = "Base class '" + config_class.base_name + "' of '" + config_class.name + "' is undefined",
+                .content = config_class.base_name,
+                .code = "CFG-001",
+        };
+    }
+}
 
 void sqfvm::language_server::analysis::config_ast::visitors::general_visitor::start(config_ast_analyzer &a) {
 }
@@ -10,17 +124,244 @@ void sqfvm::language_server::analysis::config_ast::visitors::general_visitor::en
         config_ast_analyzer &a,
         const ::sqf::parser::config::bison::astnode &node,
         const std::vector<const ::sqf::parser::config::bison::astnode *> &parent_nodes) {
+    auto parent_path = m_class_paths.empty() ? std::string{} : m_class_paths.back();
+    if (is_class(node)) {
+        auto path = join_path(parent_path, fold_case(node.token.contents));
+        t_config_class config_class{
+                .id_pk = {},
+                .file_fk = file_id_of(a, node),
+                .source_file_fk = {},
+                .name = node.token.contents,
+                .path = path,
+                .parent_path = parent_path,
+                .base_name = {},
+                .opt_base_path = {},
+                .line = node.token.line,
+                .column = node.token.column,
+                .offset = node.token.offset,
+                .base_line = 0,
+                .base_column = 0,
+        };
+        // Classes with a base carry the name of their base as first child
+        if (node.kind == astkind::CONFIGNODE_PARENT && !node.children.empty()) {
+            const auto &base = node.children.front();
+            config_class.base_name = base.token.contents;
+            config_class.base_line = base.token.line;
+            config_class.base_column = base.token.column;
+        }
+        m_config_classes.push_back(std::move(config_class));
+        m_class_paths.push_back(std::move(path));
+    } else if (is_property(node)) {
+        m_config_properties.push_back(t_config_property{
+                .id_pk = {},
+                .file_fk = file_id_of(a, node),
+                .source_file_fk = {},
+                .class_path = parent_path,
+                .name = node.token.contents,
+                .value = node.children.empty() ? std::string{} : value_of(node.children.back()),
+                .is_append = node.kind == astkind::VALUENODE_ADDARRAY,
+                .line = node.token.line,
+                .column = node.token.column,
+                .offset = node.token.offset,
+        });
+    }
 }
+
 void sqfvm::language_server::analysis::config_ast::visitors::general_visitor::exit(
         config_ast_analyzer &a,
         const ::sqf::parser::config::bison::astnode &node,
         const std::vector<const ::sqf::parser::config::bison::astnode *> &parent_nodes) {
+    if (is_class(node) && !m_class_paths.empty())
+        m_class_paths.pop_back();
 }
 
 void sqfvm::language_server::analysis::config_ast::visitors::general_visitor::end(config_ast_analyzer &a) {
 }
 
+std::optional<sqfvm::language_server::analysis::config_ast::visitors::general_visitor::class_info>
+sqfvm::language_server::analysis::config_ast::visitors::general_visitor::class_at(
+        config_ast_analyzer &a,
+        const std::string &path) {
+    auto it = m_known_classes.find(path);
+    if (it != m_known_classes.end())
+        return it->second;
+    using namespace sqlite_orm;
+    // Rows of the analyzed file are outdated by this analysis and hence skipped
+    auto rows = context_of(a).storage().get_all<t_config_class>(
+            where(c(&t_config_class::path) == path
+                  and c(&t_config_class::source_file_fk) != file_of(a).id_pk),
+            limit(1));
+    if (rows.empty())
+        return std::nullopt;
+    auto info = class_info{.name = rows.front().name, .opt_base_path = rows.front().opt_base_path};
+    m_known_classes.emplace(path, info);
+    return info;
+}
+
+std::optional<std::string> sqfvm::language_server::analysis::config_ast::visitors::general_visitor::resolve_base(
+        config_ast_analyzer &a,
+        const t_config_class &config_class) {
+    auto base = fold_case(config_class.base_name);
+    // Like the engine, look for the base in the enclosing class first and then in every class around it.
+    // Classes inherited by an enclosing class are part of it as well (e.g. `class Turrets: Turrets`).
+    auto scope = config_class.parent_path;
+    while (true) {
+        auto candidate = join_path(scope, base);
+        if (candidate != config_class.path && class_at(a, candidate).has_value())
+            return candidate;
+        if (!scope.empty()) {
+            auto inherited = class_at(a, scope);
+            for (size_t depth = 0;
+                 depth < max_inheritance_depth && inherited.has_value() && inherited->opt_base_path.has_value();
+                 depth++) {
+                candidate = join_path(*inherited->opt_base_path, base);
+                if (class_at(a, candidate).has_value())
+                    return candidate;
+                inherited = class_at(a, *inherited->opt_base_path);
+            }
+        }
+        if (scope.empty())
+            return std::nullopt;
+        scope = parent_path_of(scope);
+    }
+}
+
+std::string sqfvm::language_server::analysis::config_ast::visitors::general_visitor::resolve_function_path(
+        config_ast_analyzer &a,
+        std::string path) {
+    const auto &config_path = file_of(a).path;
+    // Only missions resolve paths against their own root, addon configs always start at the virtual root
+    auto is_mission = fold_case(std::filesystem::path(config_path).filename().string()) == "description.ext"sv;
+    if (!is_mission || (!path.empty() && path.front() == '\\')) {
+        if (path.empty() || path.front() != '\\')
+            path.insert(path.begin(), '\\');
+        auto path_info = runtime_of(a)->fileio().get_info(path, {config_path, {}, {}});
+        if (path_info.has_value())
+            return path_info->physical;
+        if (!is_mission)
+            return path;
+    }
+    std::replace(path.begin(), path.end(), '\\', '/');
+    auto first = path.find_first_not_of('/');
+    path = first == std::string::npos ? std::string{} : path.substr(first);
+    return (std::filesystem::path(config_path).parent_path() / path).lexically_normal().string();
+}
+
+void sqfvm::language_server::analysis::config_ast::visitors::general_visitor::collect_functions(
+        config_ast_analyzer &a) {
+    std::unordered_map<std::string_view, const t_config_class *> classes;
+    for (const auto &config_class: m_config_classes) {
+        classes.emplace(config_class.path, &config_class);
+    }
+    std::unordered_map<std::string_view, std::vector<const t_config_property *>> properties;
+    for (const auto &property: m_config_properties) {
+        properties[property.class_path].push_back(&property);
+    }
+    auto property_of = [&](std::string_view class_path, std::string_view folded_name) -> std::optional<std::string> {
+        auto it = properties.find(class_path);
+        if (it == properties.end())
+            return std::nullopt;
+        // Like the engine, the last assignment wins
+        for (auto property = it->second.rbegin(); property != it->second.rend(); ++property) {
+            if (fold_case((*property)->name) == folded_name)
+                return (*property)->value;
+        }
+        return std::nullopt;
+    };
+
+    // Functions are declared as CfgFunctions/<tag>/<category>/<function>
+    for (const auto &function: m_config_classes) {
+        const auto &category_path = function.parent_path;
+        auto tag_path = parent_path_of(category_path);
+        if (tag_path.empty() || parent_path_of(tag_path) != "cfgfunctions"sv)
+            continue;
+        auto tag_class = classes.find(tag_path);
+        auto category_class = classes.find(category_path);
+        if (tag_class == classes.end() || category_class == classes.end())
+            continue;
+
+        auto tag = property_of(tag_path, "tag"sv).value_or(tag_class->second->name);
+        auto path = property_of(function.path, "file"sv);
+        if (!path.has_value()) {
+            auto directory = property_of(category_path, "file"sv)
+                    .value_or("functions\\" + category_class->second->name);
+            auto extension = property_of(function.path, "ext"sv).value_or(".sqf");
+            path = directory + "\\fn_" + function.name + extension;
+        }
+        auto physical = resolve_function_path(a, std::move(*path));
+
+        std::optional<uint64_t> opt_target_file_fk;
+        if (std::filesystem::exists(physical)) {
+            auto target_file = context_of(a).db_get_file_from_path(physical, true);
+            if (target_file.has_value())
+                opt_target_file_fk = target_file->id_pk;
+        }
+        m_config_functions.push_back(t_config_function{
+                .id_pk = {},
+                .file_fk = function.file_fk,
+                .source_file_fk = {},
+                .name = tag + "_fnc_" + function.name,
+                .path = std::move(physical),
+                .opt_target_file_fk = opt_target_file_fk,
+                .line = function.line,
+                .column = function.column,
+        });
+    }
+}
+
 void sqfvm::language_server::analysis::config_ast::visitors::general_visitor::analyze(
         sqfvm::language_server::analysis::config_ast::config_ast_analyzer &config_ast_analyzer,
         const sqfvm::language_server::database::context &context) {
+    auto &a = config_ast_analyzer;
+    auto self_file_id = file_of(a).id_pk;
+    for (const auto &config_class: m_config_classes) {
+        m_known_classes.try_emplace(config_class.path, class_info{.name = config_class.name});
+    }
+
+    // Classes are ordered by appearance, hence enclosing classes are resolved before the classes they contain
+    for (auto &config_class: m_config_classes) {
+        if (config_class.base_name.empty())
+            continue;
+        config_class.opt_base_path = resolve_base(a, config_class);
+        if (!config_class.opt_base_path.has_value()) {
+            m_diagnostics.push_back(diag_undefined_base_class_001(self_file_id, config_class));
+            continue;
+        }
+        auto &known = m_known_classes[config_class.path];
+        if (!known.opt_base_path.has_value())
+            known.opt_base_path = config_class.opt_base_path;
+
+        std::string markdown;
+        markdown.append("```cpp\nclass "sv);
+        markdown.append(config_class.name);
+        markdown.append(": "sv);
+        markdown.append(config_class.base_name);
+        markdown.append("\n```\nInherits from "sv);
+        auto base_path = config_class.opt_base_path;
+        for (size_t depth = 0; depth < max_inheritance_depth && base_path.has_value(); depth++) {
+            auto base = class_at(a, *base_path);
+            if (!base.has_value())
+                break;
+            if (depth > 0)
+                markdown.append(" → "sv);
+            markdown.append("`"sv);
+            markdown.append(base->name);
+            markdown.append("`"sv);
+            base_path = base->opt_base_path;
+        }
+        m_hovers.push_back(hover_tuple{
+                .hover = {
+                        .id_pk = {},
+                        .file_fk = config_class.file_fk,
+                        .start_line = config_class.line,
+                        .start_column = config_class.column,
+                        .end_line = config_class.line,
+                        .end_column = config_class.column + config_class.name.length(),
+                        .content_fk = {},
+                },
+                .markdown = std::move(markdown),
+        });
+    }
+
+    collect_functions(a);
 }
@@ -11,9 +11,34 @@
 #include <numeric>
 #include <optional>
 #include <stack>
+#include <unordered_map>
 
 namespace sqfvm::language_server::analysis::config_ast::visitors {
     class general_visitor : public ast_visitor {
+        // The paths of all classes enclosing the node currently visited, innermost last.
+        std::vector<std::string> m_class_paths;
+
+        // Resolves the base_name of the given class against the classes known, see t_config_class::opt_base_path.
+        std::optional<std::string> resolve_base(
+                config_ast_analyzer &a,
+                const database::tables::t_config_class &config_class);
+
+        // The name and resolved base of the class with the given path, preferring the classes of this analysis.
+        struct class_info {
+            std::string name;
+            std::optional<std::string> opt_base_path;
+        };
+        std::unordered_map<std::string, class_info> m_known_classes;
+
+        std::optional<class_info> class_at(config_ast_analyzer &a, const std::string &path);
+
+        // Resolves a path of CfgFunctions to a physical path. Paths of addon configs and paths starting with
+        // a backslash are virtual, all others are relative to the mission root. Virtual paths that cannot be
+        // resolved are returned as is.
+        std::string resolve_function_path(config_ast_analyzer &a, std::string path);
+
+        // Collects the functions declared in CfgFunctions into m_config_functions.
+        void collect_functions(config_ast_analyzer &a);
     public:
         ~general_visitor() override = default;
 
@@ -5,7 +5,9 @@
 #include "../analyzer.hpp"
 #include <string>
 #include <algorithm>
+#include <cstdint>
 #include <filesystem>
+#include <initializer_list>
 #include "parser/sqf/tokenizer.hpp"
 #include "parser/sqf/astnode.hpp"
 
@@ -17,14 +19,36 @@ namespace sqfvm::language_server::analysis::sqf_ast {
             database::tables::t_code_action code_action;
             std::vector<database::tables::t_code_action_change> changes;
         };
+        struct hover_tuple {
+            database::tables::t_hover hover;
+            std::string markdown;
+        };
         std::vector<database::tables::t_reference> m_references;
         std::vector<database::tables::t_variable> m_variables;
+        std::vector<database::tables::t_scope> m_scopes;
         std::vector<database::tables::t_diagnostic> m_diagnostics;
-        std::vector<database::tables::t_hover> m_hovers;
+        std::vector<hover_tuple> m_hovers;
         std::vector<code_action_tuple> m_code_actions;
 
+        // Bit per astkind (see kind_bit) for which enter and exit are called. Defaults to all kinds.
+        uint64_t m_subscribed_kinds = ~uint64_t{0};
+
         friend class sqf_ast_analyzer;
 
+        // Kinds beyond the width of the mask share its last bit.
+        [[nodiscard]] static constexpr uint64_t kind_bit(sqf::parser::sqf::bison::astkind kind) {
+            auto index = static_cast<uint64_t>(kind);
+            return uint64_t{1} << (index < 63 ? index : 63);
+        }
+
+        // Restricts enter and exit to nodes of the given kinds. Meant to be called from start.
+        void subscribe(std::initializer_list<sqf::parser::sqf::bison::astkind> kinds) {
+            m_subscribed_kinds = 0;
+            for (auto kind: kinds) {
+                m_subscribed_kinds |= kind_bit(kind);
+            }
+        }
+
         std::filesystem::path ls_folder_of(sqf_ast_analyzer &a) const {
             return a.m_ls_path;
         }
@@ -56,8 +80,8 @@ namespace sqfvm::language_server::analysis::sqf_ast {
             return a.m_preprocessed_text;
         }
 
-        std::string scope_name_of(sqf_ast_analyzer &a) const {
-            return a.scope_name();
+        uint64_t file_id_of(sqf_ast_analyzer &a, const sqf::parser::sqf::bison::astnode &node) const {
+            return a.file_id_of(node);
         }
 
         [[nodiscard]] bool is_private_variable(std::string_view name) const {
@@ -80,6 +104,10 @@ namespace sqfvm::language_server::analysis::sqf_ast {
     public:
         virtual ~ast_visitor() = default;
 
+        [[nodiscard]] bool is_subscribed_to(sqf::parser::sqf::bison::astkind kind) const {
+            return (m_subscribed_kinds & kind_bit(kind)) != 0;
+        }
+
         virtual void start(sqf_ast_analyzer &a) = 0;
 
         virtual void enter(
@@ -1,12 +1,18 @@
 #include "sqf_ast_analyzer.hpp"
 #include "ast_visitor.hpp"
 #include "../../util.hpp"
+#include "../../database/row_diff.hpp"
 #include "visitors/general_visitor.hpp"
 #include "visitors/scripted_visitor.hpp"
 #include "../../runtime_logger.hpp"
+#include <chrono>
 #include <functional>
+#include <optional>
+#include <string_view>
+#include <tuple>
 #include <utility>
 #include <unordered_map>
+#include <unordered_set>
 #include <operators/ops.h>
 #include <fileio/default.h>
 #include <parser/sqf/sqf_parser.hpp>
@@ -48,16 +54,56 @@ void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::commit() {
     try {
 
         // Call analyze on all visitors
+        auto analyze_start = std::chrono::steady_clock::now();
         for (auto &visitor: m_visitors) {
             visitor->analyze(*this, m_context);
         }
+        m_statistics.visitors_analyze_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - analyze_start);
+
+#pragma region Scopes
+        // Get all scopes related to this file, identified by their ordinal
+        std::unordered_map<uint64_t, database::tables::t_scope> db_scopes_by_ordinal{};
+        for (auto &db_scope: storage.get_all<database::tables::t_scope>(
+                where(c(&database::tables::t_scope::file_fk) == m_file.id_pk))) {
+            db_scopes_by_ordinal[db_scope.ordinal] = db_scope;
+        }
+        std::unordered_map<visitor_id_pair, uint64_t> scope_map{};
+        std::unordered_set<uint64_t> mapped_scope_ids{};
 
+        // Map all scopes to their visitor. Parents always precede their children.
+        for (auto visitor_it = m_visitors.begin(); visitor_it != m_visitors.end(); ++visitor_it) {
+            auto &visitor = *visitor_it;
+            auto visitor_index = static_cast<size_t>(visitor_it - m_visitors.begin());
+            for (auto &visitor_scope: visitor->m_scopes) {
+                auto copy = visitor_scope;
+                copy.file_fk = m_file.id_pk;
+                if (copy.opt_parent_scope_fk.has_value()) {
+                    copy.opt_parent_scope_fk = scope_map.at(visitor_id_pair{
+                            .visitor_index = visitor_index,
+                            .id = *copy.opt_parent_scope_fk
+                    });
+                }
+                auto db_scope = db_scopes_by_ordinal.find(copy.ordinal);
+                if (db_scope != db_scopes_by_ordinal.end()) {
+                    copy.id_pk = db_scope->second.id_pk;
+                    if (copy.opt_parent_scope_fk != db_scope->second.opt_parent_scope_fk) {
+                        storage.update(copy);
+                        db_scope->second = copy;
+                    }
+                } else {
+                    copy.id_pk = storage.insert(copy);
+                    db_scopes_by_ordinal[copy.ordinal] = copy;
+                }
+                scope_map[visitor_id_pair{.visitor_index = visitor_index, .id = visitor_scope.id_pk}] = copy.id_pk;
+                mapped_scope_ids.insert(copy.id_pk);
+            }
+        }
+#pragma endregion
 #pragma region Variables
         // Get all variables related to this file
-        auto file_scope_name = scope_name();
-        auto file_scope_name_like_expression = file_scope_name + "%";
         std::vector<database::tables::t_variable> db_file_variables = storage.get_all<database::tables::t_variable>(
-                where(like(&database::tables::t_variable::scope, file_scope_name_like_expression)));
+                where(c(&database::tables::t_variable::opt_file_fk) == m_file.id_pk));
         std::vector<database::tables::t_variable> file_variables_mapped{};
 
 
@@ -67,12 +113,10 @@ void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::commit() {
             auto visitor_diff = visitor_it - m_visitors.begin();
             auto visitor_index = static_cast<size_t>(visitor_diff);
             for (auto &visitor_variable: visitor->m_variables) {
-                if (visitor_variable.scope.length() >= file_scope_name.length()
-                    && std::string_view(
-                        visitor_variable.scope.begin(),
-                        visitor_variable.scope.begin() + file_scope_name.length()) == file_scope_name) {
+                if (visitor_variable.opt_scope_fk.has_value()) {
                     commit_private_variable(
                             variable_map,
+                            scope_map,
                             storage,
                             db_file_variables,
                             file_variables_mapped,
@@ -93,20 +137,29 @@ void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::commit() {
         for (auto &db_variable: db_file_variables) {
             if (std::find_if(file_variables_mapped.begin(), file_variables_mapped.end(),
                              [&](auto &variable) {
-                                 return variable.scope == db_variable.scope;
+                                 return variable.id_pk == db_variable.id_pk;
                              }) == file_variables_mapped.end()) {
                 storage.remove_all<database::tables::t_reference>(
                         where(c(&database::tables::t_reference::variable_fk) == db_variable.id_pk));
                 storage.remove<database::tables::t_variable>(db_variable.id_pk);
             }
         }
+
+        // Remove all scopes that are not in the file anymore
+        std::vector<uint64_t> removed_scope_ids{};
+        for (auto &[_, db_scope]: db_scopes_by_ordinal) {
+            if (!mapped_scope_ids.contains(db_scope.id_pk))
+                removed_scope_ids.push_back(db_scope.id_pk);
+        }
+        database::remove_by_ids<database::tables::t_scope>(storage, removed_scope_ids);
 #pragma endregion
 #pragma region References
-        // Remove all references related to this file
-        storage.remove_all<database::tables::t_reference>(
+        // Get all references related to this file
+        auto db_references = storage.get_all<database::tables::t_reference>(
                 where(c(&database::tables::t_reference::source_file_fk) == m_file.id_pk));
 
-        // Add all references
+        // Map all references to their database variable
+        std::vector<database::tables::t_reference> references;
         for (auto visitor_it = m_visitors.begin(); visitor_it != m_visitors.end(); ++visitor_it) {
             auto &visitor = *visitor_it;
             auto visitor_diff = visitor_it - m_visitors.begin();
@@ -135,41 +188,51 @@ void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::commit() {
                 copy.id_pk = 0;
                 copy.source_file_fk = m_file.id_pk;
                 copy.variable_fk = variable_id;
-                insert(storage, copy);
+                references.push_back(copy);
             }
         }
+        database::apply_diff(storage, db_references, references);
 #pragma endregion
-#pragma region Code Actions
-        // Remove old code actions
-        for (auto &it: storage.get_all<database::tables::t_code_action>(
-                where(c(&database::tables::t_code_action::file_fk) == m_file.id_pk))) {
-            storage.remove_all<database::tables::t_code_action_change>(
-                    where(c(&database::tables::t_code_action_change::code_action_fk) == it.id_pk));
+#pragma region Variable types
+        // Union the types of all references per variable once, instead of on every inlay hint request
+        std::unordered_map<uint64_t, database::tables::t_reference::type_flags> variable_types{};
+        for (auto &reference: references) {
+            if (reference.is_magic_variable)
+                continue;
+            auto &types = variable_types[reference.variable_fk];
+            types = types | reference.types;
         }
-        storage.remove_all<database::tables::t_code_action>(
-                where(c(&database::tables::t_code_action::file_fk) == m_file.id_pk));
-
-        // Add new code actions
+        for (auto &db_variable: storage.get_all<database::tables::t_variable>(
+                where(c(&database::tables::t_variable::opt_file_fk) == m_file.id_pk))) {
+            auto types_it = variable_types.find(db_variable.id_pk);
+            auto types = types_it == variable_types.end()
+                         ? database::tables::t_reference::type_flags::none
+                         : types_it->second;
+            if (db_variable.types == types)
+                continue;
+            db_variable.types = types;
+            storage.update(db_variable);
+        }
+#pragma endregion
+#pragma region Code Actions
+        std::vector<std::pair<database::tables::t_code_action, std::vector<database::tables::t_code_action_change>>> code_actions;
         for (auto &visitor: m_visitors) {
             for (auto &it: visitor->m_code_actions) {
                 if (it.code_action.file_fk == 0)
                     it.code_action.file_fk = m_file.id_pk;
-                auto code_action_id = storage.insert(it.code_action);
-                for (auto &change: it.changes) {
-                    change.code_action_fk = code_action_id;
-                }
-                storage.insert_range(it.changes.begin(), it.changes.end());
+                code_actions.emplace_back(it.code_action, it.changes);
             }
         }
+        database::apply_code_action_diff(storage, m_file.id_pk, code_actions);
 #pragma endregion
 #pragma region Hovers
         if (!m_preprocessed_text.empty()) {
-            // Remove old hovers
-            storage.remove_all<database::tables::t_hover>(
+            auto db_hovers = storage.get_all<database::tables::t_hover>(
                     where(c(&database::tables::t_hover::file_fk) == m_file.id_pk));
 
-            // Add new hovers
+            // Collect new hovers
             std::vector<database::tables::t_hover> hovers;
+            std::vector<std::string> markdowns;
             std::stringstream hover_text;
             for (auto &it: m_hover_tuples) {
                 if (std::filesystem::path(it.path) != m_file.path)
@@ -188,49 +251,71 @@ void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::commit() {
                         it.start_column,
                         it.end_line,
                         it.end_column,
-                        hover_text.str());
+                        0);
+                markdowns.push_back(hover_text.str());
                 hover_text.str("");
             }
-            storage.insert_range(hovers.begin(), hovers.end());
             for (auto &visitor: m_visitors) {
                 for (auto &it: visitor->m_hovers) {
-                    if (it.file_fk == 0)
-                        it.file_fk = m_file.id_pk;
+                    if (it.hover.file_fk == 0)
+                        it.hover.file_fk = m_file.id_pk;
+                    hovers.push_back(it.hover);
+                    markdowns.push_back(it.markdown);
                 }
-                storage.insert_range(visitor->m_hovers.begin(), visitor->m_hovers.end());
             }
+
+            // Macro hovers repeat the same expansion all over a project, hence the markdown is stored once
+            auto content_ids = database::intern_hover_contents(storage, markdowns);
+            for (size_t i = 0; i < hovers.size(); i++) {
+                hovers[i].content_fk = content_ids[i];
+            }
+            std::unordered_set<uint64_t> stale_content_ids;
+            for (const auto &it: db_hovers) {
+                stale_content_ids.insert(it.content_fk);
+            }
+            for (auto content_id: content_ids) {
+                stale_content_ids.erase(content_id);
+            }
+            database::apply_diff(storage, db_hovers, hovers);
+            database::remove_unreferenced_hover_contents(storage, stale_content_ids);
+        }
+#pragma endregion
+#pragma region Folding ranges
+        {
+            auto db_folding_ranges = storage.get_all<database::tables::t_folding_range>(
+                    where(c(&database::tables::t_folding_range::file_fk) == m_file.id_pk));
+            database::apply_diff(storage, db_folding_ranges, m_folding_ranges);
         }
 #pragma endregion
 #pragma region Includes
         if (!m_preprocessed_text.empty()) {
-            // Remove old includes
-            storage.remove_all<database::tables::t_file_include>(
+            auto db_file_includes = storage.get_all<database::tables::t_file_include>(
                     where(c(&database::tables::t_file_include::source_file_fk) == m_file.id_pk));
 
-            // Add new includes
+            // Collect new includes
             std::vector<database::tables::t_file_include> file_includes;
             for (auto &it: m_file_include) {
-                auto included_path_file = m_context.db_get_file_from_path(it.included_path);
-                if (!included_path_file.has_value())
+                auto included_file_id = file_id_of_path(it.included_path, false);
+                if (!included_file_id.has_value())
                     continue;
-                auto source_path_file = m_context.db_get_file_from_path(it.source_path);
-                if (!source_path_file.has_value())
+                auto source_file_id = file_id_of_path(it.source_path, false);
+                if (!source_file_id.has_value())
                     continue;
                 file_includes.emplace_back(
                         0,
-                        included_path_file->id_pk,
-                        source_path_file->id_pk,
+                        *included_file_id,
+                        *source_file_id,
                         m_file.id_pk);
             }
-            storage.insert_range(file_includes.begin(), file_includes.end());
+            database::apply_diff(storage, db_file_includes, file_includes);
         }
 #pragma endregion
 #pragma region Diagnostics
-        // Remove old diagnostics
-        storage.remove_all<database::tables::t_diagnostic>(
+        auto db_diagnostics = storage.get_all<database::tables::t_diagnostic>(
                 where(c(&database::tables::t_diagnostic::source_file_fk) == m_file.id_pk));
 
-        // Add new diagnostics
+        // Collect new diagnostics
+        std::vector<database::tables::t_diagnostic> diagnostics;
         for (auto &it: m_diagnostics) {
             if (it.file_fk == 0)
                 it.file_fk = m_file.id_pk;
@@ -240,8 +325,8 @@ void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::commit() {
                                ? m_file.path
                                : m_context.storage().get<database::tables::t_file>(it.file_fk).path;
             it.is_suppressed = !m_slspp_context->can_report(it.code, path, it.line);
+            diagnostics.push_back(it);
         }
-        storage.insert_range(m_diagnostics.begin(), m_diagnostics.end());
         for (auto &visitor: m_visitors) {
             for (auto &it: visitor->m_diagnostics) {
                 if (it.file_fk == 0)
@@ -252,9 +337,10 @@ void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::commit() {
                                    ? m_file.path
                                    : m_context.storage().get<database::tables::t_file>(it.file_fk).path;
                 it.is_suppressed = !m_slspp_context->can_report(it.code, path, it.line);
+                diagnostics.push_back(it);
             }
-            storage.insert_range(visitor->m_diagnostics.begin(), visitor->m_diagnostics.end());
         }
+        database::apply_diff(storage, db_diagnostics, diagnostics);
 #pragma endregion
 
         // Remove outdated flag
@@ -278,6 +364,7 @@ void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::commit() {
 
 void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::commit_private_variable(
         std::unordered_map<visitor_id_pair, uint64_t> &variable_map,
+        const std::unordered_map<visitor_id_pair, uint64_t> &scope_map,
         database::context::storage_t &storage,
         std::vector<database::tables::t_variable> &db_file_variables,
         std::vector<database::tables::t_variable> &file_variables_mapped,
@@ -287,12 +374,16 @@ void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::commit_private
             .visitor_index = visitor_index,
             .id = visitor_variable.id_pk
     };
+    auto scope_id = scope_map.at(visitor_id_pair{
+            .visitor_index = visitor_index,
+            .id = visitor_variable.opt_scope_fk.value()
+    });
     // This variable is in this file
     auto db_variable = std::find_if(
             db_file_variables.begin(),
             db_file_variables.end(),
             [&](auto &db_variable) {
-                return db_variable.scope == visitor_variable.scope
+                return db_variable.opt_scope_fk == scope_id
                        && iequal(db_variable.variable_name, visitor_variable.variable_name);
             });
     if (db_variable != db_file_variables.end()) {
@@ -301,6 +392,7 @@ void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::commit_private
     } else {
         auto copy = visitor_variable;
         copy.id_pk = 0;
+        copy.opt_scope_fk = scope_id;
         // Variable does not exist
         auto insert_res = storage.insert(copy);
         variable_map[visitor_pair] = insert_res;
@@ -337,54 +429,155 @@ void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::commit_non_pri
     }
 }
 
-void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::insert(
-        database::context::storage_t &storage,
-        const database::tables::t_reference &copy) const {
-    try {
-        storage.insert(copy);
-    } catch (std::exception &e) {
-        std::stringstream sstream;
-        sstream << "Failed to insert into " << database::tables::t_reference::table_name << "." << "\n";
-        sstream << "What: " << "\n";
-        sstream << "    " << e.what() << "\n";
-        sstream << "Data: " << "\n";
-        sstream << "    file_fk: " << copy.file_fk << "\n";
-        sstream << "    variable_fk: " << copy.variable_fk << "\n";
-        sstream << "    access: " << static_cast<int>(copy.access) << "\n";
-        sstream << "    line: " << copy.line << "\n";
-        sstream << "    column: " << copy.column << "\n";
-        sstream << "    offset: " << copy.offset << "\n";
-        sstream << "    length: " << copy.length << "\n";
-        sstream << "    types: " << static_cast<int>(copy.types);
-
-        throw std::runtime_error(sstream.str());
+void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::traverse(
+        const sqf::parser::sqf::bison::astnode &root) {
+    struct frame {
+        const sqf::parser::sqf::bison::astnode *node;
+        size_t next_child;
+        bool in_file;
+        // The last line of the subtree located in the analyzed file, if any.
+        std::optional<uint64_t> last_line;
+    };
+    std::vector<frame> stack;
+    auto enter = [&](const sqf::parser::sqf::bison::astnode &node) {
+        m_statistics.visited_nodes++;
+        for (auto &visitor: m_visitors) {
+            if (visitor->is_subscribed_to(node.kind))
+                visitor->enter(*this, node, m_descend_ast_nodes);
+        }
+        auto in_file = is_in_analyzed_file(node);
+        stack.push_back({
+                .node = &node,
+                .next_child = 0,
+                .in_file = in_file,
+                .last_line = in_file ? std::optional<uint64_t>(node.token.line) : std::nullopt,
+        });
+        m_descend_ast_nodes.push_back(&node);
+    };
+
+    enter(root);
+    while (!stack.empty()) {
+        auto &top = stack.back();
+        if (top.next_child < top.node->children.size()) {
+            enter(top.node->children[top.next_child++]);
+            continue;
+        }
+        auto done = top;
+        stack.pop_back();
+        m_descend_ast_nodes.pop_back();
+        const auto &node = *done.node;
+        for (auto &visitor: m_visitors) {
+            if (visitor->is_subscribed_to(node.kind))
+                visitor->exit(*this, node, m_descend_ast_nodes);
+        }
+        if (done.in_file
+            && (node.kind == sqf::parser::sqf::bison::astkind::CODE
+                || node.kind == sqf::parser::sqf::bison::astkind::ARRAY)
+            && *done.last_line > node.token.line) {
+            m_folding_ranges.push_back({
+                    .id_pk = 0,
+                    .file_fk = m_file.id_pk,
+                    .start_line = node.token.line - 1,
+                    .end_line = *done.last_line - 1,
+                    .kind = node.kind == sqf::parser::sqf::bison::astkind::CODE
+                            ? database::tables::t_folding_range::code
+                            : database::tables::t_folding_range::array,
+            });
+        }
+        if (!stack.empty() && done.last_line.has_value()) {
+            auto &parent_last_line = stack.back().last_line;
+            if (!parent_last_line.has_value() || *done.last_line > *parent_last_line)
+                parent_last_line = done.last_line;
+        }
     }
 }
 
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "misc-no-recursion"
-
-void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::recurse(
-        const sqf::parser::sqf::bison::astnode &parent) {
-    for (auto &visitor: m_visitors) {
-        visitor->enter(*this, parent, m_descend_ast_nodes);
-    }
-    m_descend_ast_nodes.push_back(&parent);
-    for (auto &child: parent.children) {
-        recurse(child);
-    }
-    m_descend_ast_nodes.pop_back();
-    for (auto &visitor: m_visitors) {
-        visitor->exit(*this, parent, m_descend_ast_nodes);
+bool sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::is_in_analyzed_file(
+        const sqf::parser::sqf::bison::astnode &node) {
+    if (!node.token.path || node.token.path->empty())
+        return true;
+    // Tokens of the same file share their path, hence the comparison is only done when it changes
+    auto path = &*node.token.path;
+    if (path != m_last_token_path) {
+        m_last_token_path = path;
+        m_last_token_path_in_file = std::filesystem::path(*path).lexically_normal() == std::filesystem::path(m_file.path);
     }
+    return m_last_token_path_in_file;
+}
+
+std::optional<uint64_t> sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::file_id_of_path(
+        const std::string &path,
+        bool create_if_not_exists) {
+    auto normalized = std::filesystem::path(path).lexically_normal().string();
+    auto it = m_file_ids_by_path.find(normalized);
+    if (it != m_file_ids_by_path.end() && (it->second.has_value() || !create_if_not_exists))
+        return it->second;
+    auto file = m_context.db_get_file_from_path(normalized, create_if_not_exists);
+    auto file_id = file.has_value() ? std::optional<uint64_t>(file->id_pk) : std::nullopt;
+    m_file_ids_by_path[normalized] = file_id;
+    return file_id;
 }
 
-#pragma clang diagnostic pop
+uint64_t sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::file_id_of(
+        const sqf::parser::sqf::bison::astnode &node) {
+    if (!node.token.path || node.token.path->empty())
+        return m_file.id_pk;
+    auto token_path = &*node.token.path;
+    auto it = m_file_ids_by_token_path.find(token_path);
+    if (it != m_file_ids_by_token_path.end())
+        return it->second;
+    auto node_path = std::filesystem::path(*token_path).lexically_normal().string();
+    auto file_id = m_file.path == node_path
+                   ? m_file.id_pk
+                   : file_id_of_path(node_path, true).value_or(m_file.id_pk);
+    m_file_ids_by_token_path.emplace(token_path, file_id);
+    return file_id;
+}
+
+void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::collect_preprocessor_folding_ranges() {
+    // Start lines of the currently open branches
+    std::vector<uint64_t> open_branches;
+    auto add = [&](uint64_t start_line, uint64_t end_line) {
+        if (end_line <= start_line)
+            return;
+        m_folding_ranges.push_back({
+                .id_pk = 0,
+                .file_fk = m_file.id_pk,
+                .start_line = start_line,
+                .end_line = end_line,
+                .kind = database::tables::t_folding_range::preprocessor,
+        });
+    };
+    std::string_view text = m_text;
+    uint64_t line = 0;
+    for (size_t line_start = 0; line_start < text.size(); line++) {
+        auto line_end = text.find('\n', line_start);
+        if (line_end == std::string_view::npos)
+            line_end = text.size();
+        auto directive = text.substr(line_start, line_end - line_start);
+        line_start = line_end + 1;
+        auto hash = directive.find_first_not_of(" \t");
+        if (hash == std::string_view::npos || directive[hash] != '#')
+            continue;
+        directive.remove_prefix(hash + 1);
+        directive.remove_prefix(std::min(directive.find_first_not_of(" \t"), directive.size()));
+        if (directive.starts_with("if")) {
+            open_branches.push_back(line);
+        } else if (directive.starts_with("else") && !open_branches.empty()) {
+            add(open_branches.back(), line - 1);
+            open_branches.back() = line;
+        } else if (directive.starts_with("endif") && !open_branches.empty()) {
+            add(open_branches.back(), line - 1);
+            open_branches.pop_back();
+        }
+    }
+}
 
 void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::analyze(sqf::runtime::runtime &runtime) {
     for (auto &visitor: m_visitors) {
         visitor->start(*this);
     }
+    collect_preprocessor_folding_ranges();
     auto parser = sqf::parser::sqf::parser(runtime.get_logger());
     auto tokenizer = sqf::parser::sqf::tokenizer(m_preprocessed_text.begin(), m_preprocessed_text.end(), m_file.path);
     sqf::parser::sqf::bison::astnode root;
@@ -392,7 +585,11 @@ void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::analyze(sqf::r
     if (!success) {
         return;
     }
-    recurse(root);
+    m_statistics.visited_nodes = 0;
+    auto traverse_start = std::chrono::steady_clock::now();
+    traverse(root);
+    m_statistics.traverse_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - traverse_start);
     for (auto &visitor: m_visitors) {
         visitor->end(*this);
     }
@@ -442,4 +639,7 @@ void sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer::file_included(
         sqf::runtime::parser::preprocessor::context &included_fileinfo,
         sqf::runtime::parser::preprocessor::context &source_fileinfo) {
     m_file_include.emplace_back(included_fileinfo.path.physical, source_fileinfo.path.physical);
+    // Seeds the lookup for the tokens of the included file and the commit of the include itself
+    file_id_of_path(included_fileinfo.path.physical, false);
+    file_id_of_path(source_fileinfo.path.physical, false);
 }
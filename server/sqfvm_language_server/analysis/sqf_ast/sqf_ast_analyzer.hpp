@@ -4,7 +4,11 @@
 #include "../slspp_context.hpp"
 #include "../sqfvm_analyzer.hpp"
 #include "../../sqfvm_factory.hpp"
+#include <chrono>
+#include <optional>
+#include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <parser/sqf/astnode.hpp>
 
@@ -24,6 +28,13 @@ namespace sqfvm::language_server::analysis::sqf_ast {
                        && id == other.id;
             }
         };
+
+        // Measurements of the last analyze and commit, reported by the benchmark.
+        struct statistics {
+            uint64_t visited_nodes;
+            std::chrono::nanoseconds traverse_duration;
+            std::chrono::nanoseconds visitors_analyze_duration;
+        };
     private:
 
         struct hover_tuple {
@@ -44,30 +55,42 @@ namespace sqfvm::language_server::analysis::sqf_ast {
         std::vector<database::tables::t_diagnostic> m_diagnostics;
         std::vector<hover_tuple> m_hover_tuples;
         std::vector<include_tuple> m_file_include;
+        std::vector<database::tables::t_folding_range> m_folding_ranges;
         std::vector<ast_visitor *> m_visitors;
         std::vector<const ::sqf::parser::sqf::bison::astnode *> m_descend_ast_nodes;
         std::filesystem::path m_ls_path;
+        statistics m_statistics{};
 
-        void recurse(const sqf::parser::sqf::bison::astnode &parent);
+        // Walks the given node and all of its children depth-first using an explicit stack, calling enter
+        // and exit of every visitor subscribed to the kind of a node.
+        void traverse(const sqf::parser::sqf::bison::astnode &root);
 
-        [[nodiscard]] std::string scope_name() const {
-            std::string scope{};
-            auto id = std::to_string(m_file.id_pk);
-            scope.reserve("scope@"sv.length() + id.length() + "://"sv.length());
-            scope.append("scope@"sv);
-            scope.append(id);
-            scope.append("://"sv);
-            return scope;
-        }
+        // The token path last checked by is_in_analyzed_file and whether it is the analyzed file.
+        const std::string *m_last_token_path = nullptr;
+        bool m_last_token_path_in_file = true;
 
-        void insert(
-                database::context::storage_t &storage,
-                const database::tables::t_reference &copy) const;
+        [[nodiscard]] bool is_in_analyzed_file(const sqf::parser::sqf::bison::astnode &node);
 
+        // File ids of all paths looked up during this analysis, by lexically normal path.
+        // nullopt if the file was not known to the database when looked up.
+        std::unordered_map<std::string, std::optional<uint64_t>> m_file_ids_by_path;
 
+        // File ids by token path. Tokens of the same file share their path, hence the pointer identifies the file.
+        std::unordered_map<const std::string *, uint64_t> m_file_ids_by_token_path;
+
+        // Returns the id of the file with the given path, querying the database only once per analysis and path
+        // unless the file is unknown and has to be created.
+        std::optional<uint64_t> file_id_of_path(const std::string &path, bool create_if_not_exists);
+
+        // Returns the id of the file the given node originates from, creating the file if it is unknown.
+        [[nodiscard]] uint64_t file_id_of(const sqf::parser::sqf::bison::astnode &node);
+
+        // Adds a folding range for every branch of the preprocessor conditionals in m_text.
+        void collect_preprocessor_folding_ranges();
 
         void commit_private_variable(
                 std::unordered_map<visitor_id_pair, uint64_t> &variable_map,
+                const std::unordered_map<visitor_id_pair, uint64_t> &scope_map,
                 database::context::storage_t &storage,
                 std::vector<database::tables::t_variable> &db_file_variables,
                 std::vector<database::tables::t_variable> &file_variables_mapped,
@@ -112,6 +135,8 @@ namespace sqfvm::language_server::analysis::sqf_ast {
 
         // Commit the analysis to the database.
         void commit() override;
+
+        [[nodiscard]] const statistics &last_statistics() const { return m_statistics; }
     };
 }
 
@@ -0,0 +1,96 @@
+#include "sqf_keyword.hpp"
+
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    using sqfvm::language_server::analysis::sqf_ast::sqf_keyword;
+
+    // Names are expected to be case-folded already.
+    constexpr std::pair<std::string_view, sqf_keyword> keywords[] = {
+            {"&&",          sqf_keyword::and_},
+            {"and",         sqf_keyword::and_},
+            {"apply",       sqf_keyword::apply},
+            {"call",        sqf_keyword::call},
+            {"catch",       sqf_keyword::catch_},
+            {":",           sqf_keyword::colon},
+            {"count",       sqf_keyword::count},
+            {"default",     sqf_keyword::default_},
+            {"do",          sqf_keyword::do_},
+            {"else",        sqf_keyword::else_},
+            {"exitwith",    sqf_keyword::exit_with},
+            {"findif",      sqf_keyword::find_if},
+            {"for",         sqf_keyword::for_},
+            {"foreach",     sqf_keyword::for_each},
+            {"getvariable", sqf_keyword::get_variable},
+            {"isnil",       sqf_keyword::is_nil},
+            {"nil",         sqf_keyword::nil},
+            {"||",          sqf_keyword::or_},
+            {"or",          sqf_keyword::or_},
+            {"params",      sqf_keyword::params},
+            {"private",     sqf_keyword::private_},
+            {"select",      sqf_keyword::select},
+            {"setvariable", sqf_keyword::set_variable},
+            {"switch",      sqf_keyword::switch_},
+            {"then",        sqf_keyword::then},
+            {"try",         sqf_keyword::try_},
+            {"waituntil",   sqf_keyword::wait_until},
+            {"while",       sqf_keyword::while_},
+    };
+
+    constexpr size_t max_keyword_length = 11;
+    constexpr size_t table_size = 64;
+
+    // FNV-1a over the case-folded characters, varied by seed.
+    uint32_t hash_of(std::string_view contents, uint32_t seed) {
+        uint32_t hash = 0x811c9dc5u ^ seed;
+        for (auto c: contents) {
+            hash ^= static_cast<uint32_t>(std::tolower(static_cast<unsigned char>(c)));
+            hash *= 0x01000193u;
+        }
+        return hash;
+    }
+
+    struct perfect_hash_table {
+        uint32_t seed = 0;
+        std::array<int, table_size> slots{};
+
+        // Searches the first seed that maps every keyword to a distinct slot.
+        perfect_hash_table() {
+            for (;; seed++) {
+                slots.fill(-1);
+                bool collides = false;
+                for (int i = 0; i < static_cast<int>(std::size(keywords)) && !collides; i++) {
+                    auto &slot = slots[hash_of(keywords[i].first, seed) % table_size];
+                    collides = slot != -1;
+                    slot = i;
+                }
+                if (!collides)
+                    return;
+                if (seed == UINT32_MAX)
+                    throw std::runtime_error("No perfect hash found for the SQF keyword table.");
+            }
+        }
+    };
+}
+
+sqfvm::language_server::analysis::sqf_ast::sqf_keyword
+sqfvm::language_server::analysis::sqf_ast::keyword_of(std::string_view contents) {
+    static const perfect_hash_table table;
+    if (contents.empty() || contents.size() > max_keyword_length)
+        return sqf_keyword::none;
+    auto index = table.slots[hash_of(contents, table.seed) % table_size];
+    if (index == -1)
+        return sqf_keyword::none;
+    const auto &[name, keyword] = keywords[index];
+    if (name.size() != contents.size())
+        return sqf_keyword::none;
+    for (size_t i = 0; i < name.size(); i++) {
+        if (std::tolower(static_cast<unsigned char>(contents[i])) != name[i])
+            return sqf_keyword::none;
+    }
+    return keyword;
+}
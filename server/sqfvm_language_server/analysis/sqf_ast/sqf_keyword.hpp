@@ -0,0 +1,43 @@
+#ifndef SQFVM_LANGUAGE_SERVER_ANALYSIS_SQF_AST_SQF_KEYWORD_HPP
+#define SQFVM_LANGUAGE_SERVER_ANALYSIS_SQF_AST_SQF_KEYWORD_HPP
+
+#include <string_view>
+
+namespace sqfvm::language_server::analysis::sqf_ast {
+    // Operators and keywords the visitors handle specially. Aliases (e.g. `&&` and `and`) share one value.
+    enum class sqf_keyword {
+        none,
+        and_,
+        apply,
+        call,
+        catch_,
+        colon,
+        count,
+        default_,
+        do_,
+        else_,
+        exit_with,
+        find_if,
+        for_,
+        for_each,
+        get_variable,
+        is_nil,
+        nil,
+        or_,
+        params,
+        private_,
+        select,
+        set_variable,
+        switch_,
+        then,
+        try_,
+        wait_until,
+        while_,
+    };
+
+    // Classifies the given token contents, ignoring case. Returns sqf_keyword::none for anything unknown.
+    // The lookup is a single probe into a perfect hash table, hence independent of the amount of keywords.
+    [[nodiscard]] sqf_keyword keyword_of(std::string_view contents);
+}
+
+#endif // SQFVM_LANGUAGE_SERVER_ANALYSIS_SQF_AST_SQF_KEYWORD_HPP
@@ -1,7 +1,12 @@
 #include "general_visitor.hpp"
 #include "../sqf_ast_analyzer.hpp"
+#include "../sqf_keyword.hpp"
 
 #include <algorithm>
+#include <cctype>
+#include <numeric>
+#include <string>
+#include <unordered_map>
 
 #define LINE_OFFSET -1
 
@@ -9,6 +14,13 @@ using namespace sqfvm::language_server::database::tables;
 using namespace std::string_view_literals;
 
 namespace {
+    std::string fold_case(std::string_view name) {
+        std::string folded(name);
+        std::transform(folded.begin(), folded.end(), folded.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        return folded;
+    }
 
     t_diagnostic diag_private_variable_value_is_never_used_001(
             uint64_t self_file_id,
@@ -343,8 +355,35 @@ namespace {
 
 
 void sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::start(sqf_ast_analyzer &a) {
+    // Has to cover every kind handled in enter and exit
+    using ::sqf::parser::sqf::bison::astkind;
+    subscribe({
+            astkind::CODE,
+            astkind::EXP0,
+            astkind::EXP1,
+            astkind::EXP2,
+            astkind::EXP3,
+            astkind::EXP4,
+            astkind::EXP5,
+            astkind::EXP6,
+            astkind::EXP7,
+            astkind::EXP8,
+            astkind::EXP9,
+            astkind::EXPU,
+            astkind::EXPN,
+            astkind::BOOLEAN_FALSE,
+            astkind::BOOLEAN_TRUE,
+            astkind::ARRAY,
+            astkind::HEXNUMBER,
+            astkind::NUMBER,
+            astkind::STRING,
+            astkind::IDENT,
+            astkind::ASSIGNMENT_LOCAL,
+            astkind::ASSIGNMENT,
+    });
+
     // Push initial scope
-    m_scope_stack.push_back({0, scope_name_of(a)});
+    m_scope_stack.push_back({create_scope(a, std::nullopt), false});
 
     // Push initial namespace
     push_namespace("missionNamespace");
@@ -410,41 +449,50 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::enter
         case ::sqf::parser::sqf::bison::astkind::EXP9:
         case ::sqf::parser::sqf::bison::astkind::EXPU: {
             expression_handle_needless_parentheses(a, node, parent_nodes);
-            auto contents = node.token.contents;
-            if (iequal(contents, "private")) {
-                expression_handling_of_private(a, node);
-            } else if (iequal(contents, "params")) {
-                expression_handling_of_params(a, node);
-            } else if (iequal(contents, "getVariable")) {
-                expression_handling_of_getvariable(a, node);
-            } else if (iequal(contents, "setVariable")) {
-                expression_handling_of_setvariable(a, node);
-            } else if (iequal(contents, "isNil")) {
-                expression_handling_of_isnil(a, node);
-            } else if (iequal(contents, "for")) {
-                // for being a unary operator, only the first child is relevant and always present.
-                // First child also always must be a string, otherwise pushing diagnostic 006 is required.
-                auto first_child = node.children.front();
-                if (first_child.kind != ::sqf::parser::sqf::bison::astkind::STRING) {
-                    m_diagnostics.push_back(diag_type_missmatch_006(
-                            file_id_of(a, node),
-                            file_of(a).id_pk,
-                            node,
-                            ::sqf::parser::sqf::bison::astkind::STRING));
-                } else {
-                    auto variable_name = first_child.token.contents;
-                    auto variable = get_or_create_variable(a, sqf_destringify(variable_name));
-                    auto reference = make_reference(a, first_child, variable, t_reference::access_flags::set);
-                    reference.is_declaration = true;
-                    m_references.push_back(reference);
+            switch (keyword_of(node.token.contents)) {
+                case sqf_keyword::private_:
+                    expression_handling_of_private(a, node);
+                    break;
+                case sqf_keyword::params:
+                    expression_handling_of_params(a, node);
+                    break;
+                case sqf_keyword::get_variable:
+                    expression_handling_of_getvariable(a, node);
+                    break;
+                case sqf_keyword::set_variable:
+                    expression_handling_of_setvariable(a, node);
+                    break;
+                case sqf_keyword::is_nil:
+                    expression_handling_of_isnil(a, node);
+                    break;
+                case sqf_keyword::for_: {
+                    // for being a unary operator, only the first child is relevant and always present.
+                    // First child also always must be a string, otherwise pushing diagnostic 006 is required.
+                    auto first_child = node.children.front();
+                    if (first_child.kind != ::sqf::parser::sqf::bison::astkind::STRING) {
+                        m_diagnostics.push_back(diag_type_missmatch_006(
+                                file_id_of(a, node),
+                                file_of(a).id_pk,
+                                node,
+                                ::sqf::parser::sqf::bison::astkind::STRING));
+                    } else {
+                        auto variable_name = first_child.token.contents;
+                        auto variable = get_or_create_variable(a, sqf_destringify(variable_name));
+                        auto reference = make_reference(a, first_child, variable, t_reference::access_flags::set);
+                        reference.is_declaration = true;
+                        m_references.push_back(reference);
+                    }
+                    break;
                 }
+                default:
+                    break;
             }
             break;
         }
         case ::sqf::parser::sqf::bison::astkind::EXPN: {
             expression_handle_needless_parentheses(a, node, parent_nodes);
             if (m_assignment_candidate.has_value()
-                && iequal(node.token.contents, "nil")
+                && keyword_of(node.token.contents) == sqf_keyword::nil
                 && is_right_side_of_assignment(parent_nodes, node)) {
                 m_assignment_candidate->types = t_reference::type_flags::nil;
                 m_assignment_candidate->id_pk = m_references.size() + 1;
@@ -1112,60 +1160,43 @@ t_reference sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor
     return reference;
 }
 
-uint64_t sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::file_id_of(
-        sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer &a,
-        const sqf::parser::sqf::bison::astnode &node) {
-    auto node_path = std::filesystem::path(*node.token.path).lexically_normal();
-    auto &file = file_of(a);
-    if (!node.token.path->empty() && file.path != node_path.string()) {
-        auto node_file = context_of(a).db_get_file_from_path(node_path, true);
-        if (node_file.has_value())
-            return node_file->id_pk;
+uint64_t sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::create_scope(
+        sqf_ast_analyzer &a,
+        std::optional<uint64_t> opt_parent_scope_id) {
+    t_scope scope{};
+    scope.id_pk = m_scopes.size() + 1;
+    scope.file_fk = file_of(a).id_pk;
+    scope.opt_parent_scope_fk = opt_parent_scope_id;
+    scope.ordinal = m_scopes.size();
+    m_scopes.push_back(scope);
+    return scope.id_pk;
+}
+
+bool sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::is_same_or_parent_scope(
+        uint64_t parent_scope_id,
+        uint64_t scope_id) const {
+    std::optional<uint64_t> current = scope_id;
+    while (current.has_value()) {
+        if (*current == parent_scope_id)
+            return true;
+        // Parents are always created before their children
+        if (*current < parent_scope_id)
+            return false;
+        current = m_scopes[*current - 1].opt_parent_scope_fk;
     }
-    return file.id_pk;
+    return false;
 }
 
-std::string sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::push_scope(
+uint64_t sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::push_scope(
         sqf_ast_analyzer &a,
         const ::sqf::parser::sqf::bison::astnode &node,
         const std::vector<const ::sqf::parser::sqf::bison::astnode *> &parent_nodes
 ) {
     bool is_detached = is_detached_scope(parent_nodes);
-    std::string scope{};
-    if (m_scope_stack.empty()) {
-        scope = "scope://";
-    } else {
-        auto &back = m_scope_stack.back();
-        auto scope_string_size = back.full_name.length() + 1;
-        if (back.child_count < 10)
-            scope_string_size += 1;
-        else if (back.child_count < 100)
-            scope_string_size += 2;
-        else if (back.child_count < 1000)
-            scope_string_size += 3;
-        else if (back.child_count < 10000)
-            scope_string_size += 4;
-        else if (back.child_count < 100000)
-            scope_string_size += 5;
-        else if (back.child_count < 1000000)
-            scope_string_size += 6;
-        else if (back.child_count < 10000000)
-            scope_string_size += 7;
-        else if (back.child_count < 100000000)
-            scope_string_size += 8;
-        else if (back.child_count < 1000000000)
-            scope_string_size += 9;
-        else
-            scope_string_size += 10;
-
-        scope.reserve(scope_string_size);
-        scope.append(back.full_name);
-        scope.append("/");
-        scope.append(std::to_string(back.child_count));
-        m_scope_stack.back().child_count++;
-    }
-    general_visitor::scope s{0, scope, is_detached};
-    m_scope_stack.push_back(s);
+    auto scope_id = create_scope(
+            a,
+            m_scope_stack.empty() ? std::nullopt : std::optional<uint64_t>(m_scope_stack.back().scope_id));
+    m_scope_stack.push_back({scope_id, is_detached});
     if (is_detached) {
         // ToDo: implement properly (not every {} scope has _this)
         auto reference = make_reference(a, node);
@@ -1176,7 +1207,7 @@ std::string sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor
         reference.is_magic_variable = true;
         m_references.push_back(reference);
     }
-    return scope;
+    return scope_id;
 }
 
 void sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::add_magic_variables_to_current_scope(
@@ -1187,20 +1218,23 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::add_m
         auto parent = parent_nodes.back();
         if (node_is_expression(*parent)) {
             std::vector<std::string> magic_variables{};
-            if (iequal(parent->token.contents, "apply")) {
-                magic_variables.emplace_back("_x");
-            } else if (iequal(parent->token.contents, "select")) {
-                magic_variables.emplace_back("_x");
-            } else if (iequal(parent->token.contents, "count")) {
-                magic_variables.emplace_back("_x");
-            } else if (iequal(parent->token.contents, "findIf")) {
-                magic_variables.emplace_back("_x");
-            } else if (iequal(parent->token.contents, "catch")) {
-                magic_variables.emplace_back("_exception");
-            } else if (iequal(parent->token.contents, "forEach")) {
-                magic_variables.emplace_back("_x");
-                magic_variables.emplace_back("_y");
-                magic_variables.emplace_back("_forEachIndex");
+            switch (keyword_of(parent->token.contents)) {
+                case sqf_keyword::apply:
+                case sqf_keyword::select:
+                case sqf_keyword::count:
+                case sqf_keyword::find_if:
+                    magic_variables.emplace_back("_x");
+                    break;
+                case sqf_keyword::catch_:
+                    magic_variables.emplace_back("_exception");
+                    break;
+                case sqf_keyword::for_each:
+                    magic_variables.emplace_back("_x");
+                    magic_variables.emplace_back("_y");
+                    magic_variables.emplace_back("_forEachIndex");
+                    break;
+                default:
+                    break;
             }
             for (auto &magic_variable: magic_variables) {
                 auto reference = make_reference(a, node);
@@ -1217,38 +1251,36 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::add_m
 
 bool sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::is_detached_scope(
         const std::vector<const ::sqf::parser::sqf::bison::astnode *> &parent_nodes) const {
-    bool is_detached = false;
-    if (!parent_nodes.empty()) {
-        auto parent = parent_nodes.back();
-        if (!node_is_expression(*parent)
-            || !(
-                iequal(parent->token.contents, "then")
-                || iequal(parent->token.contents, "else")
-                || iequal(parent->token.contents, "exitWith")
-                || iequal(parent->token.contents, "call")
-                || iequal(parent->token.contents, "while")
-                || iequal(parent->token.contents, "do")
-                || iequal(parent->token.contents, "switch")
-                || iequal(parent->token.contents, ":")
-                || iequal(parent->token.contents, "default")
-                || iequal(parent->token.contents, "isNil")
-                || iequal(parent->token.contents, "waitUntil")
-                || iequal(parent->token.contents, "try")
-                || iequal(parent->token.contents, "catch")
-                || iequal(parent->token.contents, "count")
-                || iequal(parent->token.contents, "forEach")
-                || iequal(parent->token.contents, "apply")
-                || iequal(parent->token.contents, "select")
-                || iequal(parent->token.contents, "findIf")
-                || iequal(parent->token.contents, "&&")
-                || iequal(parent->token.contents, "and")
-                || iequal(parent->token.contents, "||")
-                || iequal(parent->token.contents, "or")
-        )) {
-            is_detached = true;
-        }
+    if (parent_nodes.empty())
+        return false;
+    auto parent = parent_nodes.back();
+    if (!node_is_expression(*parent))
+        return true;
+    switch (keyword_of(parent->token.contents)) {
+        case sqf_keyword::then:
+        case sqf_keyword::else_:
+        case sqf_keyword::exit_with:
+        case sqf_keyword::call:
+        case sqf_keyword::while_:
+        case sqf_keyword::do_:
+        case sqf_keyword::switch_:
+        case sqf_keyword::colon:
+        case sqf_keyword::default_:
+        case sqf_keyword::is_nil:
+        case sqf_keyword::wait_until:
+        case sqf_keyword::try_:
+        case sqf_keyword::catch_:
+        case sqf_keyword::count:
+        case sqf_keyword::for_each:
+        case sqf_keyword::apply:
+        case sqf_keyword::select:
+        case sqf_keyword::find_if:
+        case sqf_keyword::and_:
+        case sqf_keyword::or_:
+            return false;
+        default:
+            return true;
     }
-    return is_detached;
 }
 
 bool sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::node_is_expression(
@@ -1274,19 +1306,18 @@ t_variable sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor:
         sqf_ast_analyzer &a,
         std::string_view name,
         bool is_declaration) {
+    auto folded_name = fold_case(name);
     if (is_private_variable(name)) {
         if (!is_declaration) {
             for (auto scope_reverse_it = m_scope_stack.rbegin();
                  scope_reverse_it != m_scope_stack.rend(); ++scope_reverse_it) {
                 auto &scope = *scope_reverse_it;
-                auto find_res = std::find_if(
-                        m_variables.begin(),
-                        m_variables.end(),
-                        [name, &scope](auto val) {
-                            return iequal(val.variable_name, name) && val.scope == scope.full_name;
-                        });
-                if (find_res != m_variables.end()) {
-                    return *find_res;
+                auto scope_it = m_private_variable_indices.find(scope.scope_id);
+                if (scope_it != m_private_variable_indices.end()) {
+                    auto find_res = scope_it->second.find(folded_name);
+                    if (find_res != scope_it->second.end()) {
+                        return m_variables[find_res->second];
+                    }
                 }
                 if (scope.is_detached)
                     break;
@@ -1296,23 +1327,21 @@ t_variable sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor:
         variable.variable_name = name;
         variable.opt_file_fk = file_of(a).id_pk;
         variable.id_pk = m_variables.size() + 1;
-        variable.scope = m_scope_stack.back().full_name;
+        variable.opt_scope_fk = m_scope_stack.back().scope_id;
+        // Lookups resolve to the first private of a scope, even if it is declared again
+        m_private_variable_indices[*variable.opt_scope_fk].try_emplace(std::move(folded_name), m_variables.size());
         m_variables.push_back(variable);
         return variable;
     } else {
-        auto find_res = std::find_if(
-                m_variables.begin(),
-                m_variables.end(),
-                [name](auto val) {
-                    return iequal(val.variable_name, name);
-                });
-        if (find_res != m_variables.end()) {
-            return *find_res;
+        auto find_res = m_global_variable_indices.find(folded_name);
+        if (find_res != m_global_variable_indices.end()) {
+            return m_variables[find_res->second];
         } else {
             t_variable variable{};
             variable.variable_name = name;
             variable.id_pk = m_variables.size() + 1;
             variable.scope = get_namespace();
+            m_global_variable_indices.emplace(std::move(folded_name), m_variables.size());
             m_variables.push_back(variable);
             return variable;
         }
@@ -1325,65 +1354,91 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::analy
     using namespace sqlite_orm;
     auto file_id = file_of(sqf_ast_analyzer).id_pk;
 
+    // Index of every variable in m_variables by its id
+    std::unordered_map<uint64_t, size_t> variable_indices;
+    variable_indices.reserve(m_variables.size());
+    for (size_t i = 0; i < m_variables.size(); i++) {
+        variable_indices.emplace(m_variables[i].id_pk, i);
+    }
+    auto variable_of = [&](const t_reference &reference) -> const t_variable * {
+        auto it = variable_indices.find(reference.variable_fk);
+        return it == variable_indices.end() ? nullptr : &m_variables[it->second];
+    };
+
+    // Indices into m_references, bucketed by variable (in the order of m_variables) while keeping the read order.
+    // The references of m_variables[i] are reference_buckets[bucket_offsets[i] .. bucket_offsets[i + 1]).
+    std::vector<size_t> bucket_offsets(m_variables.size() + 1, 0);
+    for (const auto &reference: m_references) {
+        auto it = variable_indices.find(reference.variable_fk);
+        if (it != variable_indices.end())
+            bucket_offsets[it->second + 1]++;
+    }
+    std::partial_sum(bucket_offsets.begin(), bucket_offsets.end(), bucket_offsets.begin());
+    std::vector<size_t> reference_buckets(bucket_offsets.back());
+    {
+        std::vector<size_t> bucket_ends(bucket_offsets.begin(), bucket_offsets.end() - 1);
+        for (size_t i = 0; i < m_references.size(); i++) {
+            auto it = variable_indices.find(m_references[i].variable_fk);
+            if (it != variable_indices.end())
+                reference_buckets[bucket_ends[it->second]++] = i;
+        }
+    }
+
 #pragma region Find all variables which are only set once and never read
-    for (auto &variable: m_variables) {
-        for (auto it = m_references.begin(); it != m_references.end(); it++) {
-            if (it->variable_fk != variable.id_pk || it->access != t_reference::access_flags::set ||
-                it->is_magic_variable)
-                continue; // ToDo: Optimize the lookup as we are O(N^M) here
-            const auto &initial_reference = it;
+    for (size_t variable_index = 0; variable_index < m_variables.size(); variable_index++) {
+        const auto &variable = m_variables[variable_index];
+        auto bucket_end = bucket_offsets[variable_index + 1];
+        for (auto k = bucket_offsets[variable_index]; k < bucket_end; k++) {
+            const auto &initial_reference = m_references[reference_buckets[k]];
+            if (initial_reference.access != t_reference::access_flags::set || initial_reference.is_magic_variable)
+                continue;
 
-            if (it->types == database::tables::t_reference::type_flags::nil)
+            if (initial_reference.types == database::tables::t_reference::type_flags::nil)
                 continue; // we treat nil assignment as intentional
 
-            // We just need to check the following references due to read order
-            auto next_reference = std::find_if(initial_reference + 1, m_references.end(),
-                                               [&variable](const t_reference &reference) {
-                                                   return reference.variable_fk == variable.id_pk;
-                                               });
-            if (next_reference == m_references.end() || next_reference->access != t_reference::access_flags::get) {
+            // We just need to check the following reference due to read order
+            if (k + 1 == bucket_end
+                || m_references[reference_buckets[k + 1]].access != t_reference::access_flags::get) {
                 if (is_private_variable(variable)) {
                     m_diagnostics.push_back(diag_private_variable_value_is_never_used_001(
                             file_id,
                             variable,
-                            *initial_reference));
+                            initial_reference));
                 } else {
                     m_diagnostics.push_back(diag_global_variable_value_is_never_used_in_file_002(
                             file_id,
                             variable,
-                            *initial_reference));
+                            initial_reference));
                 }
             }
         }
     }
 #pragma endregion
 #pragma region Find all variables which are never set
-    for (auto &variable: m_variables) {
-        for (auto it = m_references.begin(); it != m_references.end(); it++) {
-            if (it->variable_fk != variable.id_pk || it->access != t_reference::access_flags::get ||
-                it->is_magic_variable)
-                continue; // ToDo: Optimize the lookup as we are O(N^M) here
-            const auto &initial_reference = it;
-            // We just need to check the previous references due to read order
-            auto previous_set = std::find_if(
-                    m_references.begin(),
-                    initial_reference,
-                    [&variable](const t_reference &reference) {
-                        return reference.variable_fk == variable.id_pk
-                               && reference.access == t_reference::access_flags::set;
-                    });
-            if (previous_set == initial_reference) {
-                if (is_private_variable(variable)) {
-                    m_diagnostics.push_back(diag_private_variable_is_never_assigned_003(
-                            file_id,
-                            variable,
-                            *initial_reference));
-                } else {
-                    m_diagnostics.push_back(diag_global_variable_never_assigned_in_file_in_file_004(
-                            file_id,
-                            variable,
-                            *initial_reference));
-                }
+    for (size_t variable_index = 0; variable_index < m_variables.size(); variable_index++) {
+        const auto &variable = m_variables[variable_index];
+        // We just need to check the previous references due to read order
+        bool was_set = false;
+        for (auto k = bucket_offsets[variable_index]; k < bucket_offsets[variable_index + 1]; k++) {
+            const auto &initial_reference = m_references[reference_buckets[k]];
+            if (initial_reference.access == t_reference::access_flags::set) {
+                was_set = true;
+                continue;
+            }
+            if (initial_reference.access != t_reference::access_flags::get || initial_reference.is_magic_variable)
+                continue;
+            if (was_set)
+                continue;
+            if (is_private_variable(variable)) {
+                m_diagnostics.push_back(diag_private_variable_is_never_assigned_003(
+                        file_id,
+                        variable,
+                        initial_reference));
+            } else {
+                m_diagnostics.push_back(diag_global_variable_never_assigned_in_file_in_file_004(
+                        file_id,
+                        variable,
+                        initial_reference));
             }
         }
     }
@@ -1392,31 +1447,26 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::analy
     for (auto &reference: m_references) {
         if (reference.is_magic_variable)
             continue;
-        auto find_res = std::find_if(
-                m_variables.begin(),
-                m_variables.end(),
-                [&reference](const t_variable &var) {
-                    return var.id_pk == reference.variable_fk;
-                });
-        if (find_res == m_variables.end())
+        auto variable = variable_of(reference);
+        if (variable == nullptr)
             continue;
         auto reference_content = text_of(sqf_ast_analyzer).substr(reference.offset, reference.length);
         if (!reference_content.empty() && (reference_content[0] == '"' || reference_content[0] == '\'')) {
             // Compare variable name with variable name in reference
             auto destringified = sqf_destringify(reference_content);
-            if (find_res->variable_name != destringified) {
+            if (variable->variable_name != destringified) {
                 m_diagnostics.push_back(diag_variable_name_not_similar_005(
                         file_id,
-                        *find_res,
+                        *variable,
                         reference,
                         destringified));
             }
         } else {
             // Compare variable name with variable name in reference
-            if (find_res->variable_name != reference_content) {
+            if (variable->variable_name != reference_content) {
                 m_diagnostics.push_back(diag_variable_name_not_similar_005(
                         file_id,
-                        *find_res,
+                        *variable,
                         reference,
                         reference_content));
             }
@@ -1424,60 +1474,33 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::general_visitor::analy
     }
 #pragma endregion
 #pragma region Find all private variable which are shadowing other private variables
-    for (auto it = m_references.begin(); it != m_references.end(); it++) {
-        auto test_reference = *it;
-        if (test_reference.is_magic_variable)
+    // Indices of all private declarations read so far, by case-folded variable name
+    std::unordered_map<std::string, std::vector<size_t>> private_declarations;
+    for (size_t i = 0; i < m_references.size(); i++) {
+        const auto &test_reference = m_references[i];
+        auto test_variable = variable_of(test_reference);
+        if (test_variable == nullptr || !is_private_variable(*test_variable))
             continue;
-        if (!test_reference.is_declaration)
-            continue;
-        auto find_res = std::find_if(
-                m_variables.begin(),
-                m_variables.end(),
-                [&test_reference](const t_variable &var) {
-                    return var.id_pk == test_reference.variable_fk;
-                });
-        if (find_res == m_variables.end())
-            continue;
-        if (!is_private_variable(*find_res))
-            continue;
-        auto test_variable = *find_res;
-        auto shadowing_reference = std::find_if(
-                m_references.begin(),
-                it,
-                [&](const t_reference &ref) {
-                    if (ref.access != t_reference::access_flags::set
-                        || !ref.is_declaration) {
-                        return false;
-                    }
-                    auto find_res = std::find_if(
-                            m_variables.begin(),
-                            m_variables.end(),
-                            [&ref](const t_variable &var) {
-                                return var.id_pk == ref.variable_fk;
-                            });
-                    if (find_res == m_variables.end())
-                        return false;
-                    if (!is_private_variable(*find_res))
-                        return false;
-                    if (!iequal(find_res->variable_name, test_variable.variable_name))
-                        return false;
-                    if (find_res->scope.length() > test_variable.scope.length())
-                        return false;
-                    return std::equal(
-                            find_res->scope.begin(),
-                            find_res->scope.end(),
-                            test_variable.scope.begin());
-                });
-        if (shadowing_reference != it) {
-            m_diagnostics.push_back(diag_private_variable_is_shadowing_other_private_variable_009(
-                    file_id,
-                    test_variable,
-                    test_reference));
-            m_diagnostics.push_back(diag_private_variable_is_shadowed_by_another_private_variable_009(
-                    file_id,
-                    test_variable,
-                    *shadowing_reference));
+        auto &candidates = private_declarations[fold_case(test_variable->variable_name)];
+        if (!test_reference.is_magic_variable && test_reference.is_declaration && test_variable->opt_scope_fk.has_value()) {
+            auto shadowing_reference = std::find_if(candidates.begin(), candidates.end(), [&](size_t candidate) {
+                auto variable = variable_of(m_references[candidate]);
+                return variable->opt_scope_fk.has_value()
+                       && is_same_or_parent_scope(*variable->opt_scope_fk, *test_variable->opt_scope_fk);
+            });
+            if (shadowing_reference != candidates.end()) {
+                m_diagnostics.push_back(diag_private_variable_is_shadowing_other_private_variable_009(
+                        file_id,
+                        *test_variable,
+                        test_reference));
+                m_diagnostics.push_back(diag_private_variable_is_shadowed_by_another_private_variable_009(
+                        file_id,
+                        *test_variable,
+                        m_references[*shadowing_reference]));
+            }
         }
+        if (test_reference.access == t_reference::access_flags::set && test_reference.is_declaration)
+            candidates.push_back(i);
     }
 #pragma endregion
 }
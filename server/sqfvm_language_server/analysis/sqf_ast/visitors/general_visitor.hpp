@@ -4,22 +4,20 @@
 #include "../ast_visitor.hpp"
 #include "../../../database/tables/t_reference.h"
 #include "../../../database/tables/t_variable.h"
-#include "../../../database/tables/t_variable.h"
+#include "../../../database/tables/t_scope.h"
 #include <vector>
 #include <string>
 #include <string_view>
 #include <numeric>
 #include <optional>
 #include <stack>
+#include <unordered_map>
 
 namespace sqfvm::language_server::analysis::sqf_ast::visitors {
     class general_visitor : public ast_visitor {
         struct scope {
-            // The amount of children this scope has
-            size_t child_count;
-
-            // The scope's name used to identify a variable during visitation
-            std::string full_name;
+            // The visitor-local id of the t_scope in m_scopes
+            uint64_t scope_id;
 
             // Whether this scope is detached from the parent scope, aborting further lookup for variables
             // once this scope is reached
@@ -31,6 +29,11 @@ namespace sqfvm::language_server::analysis::sqf_ast::visitors {
         std::stack<database::tables::t_reference> m_method_temporary_stack;
         std::optional<database::tables::t_reference> m_assignment_candidate;
 
+        // Index into m_variables of the first private created per scope id and case-folded name.
+        std::unordered_map<uint64_t, std::unordered_map<std::string, size_t>> m_private_variable_indices;
+        // Index into m_variables of every global by case-folded name.
+        std::unordered_map<std::string, size_t> m_global_variable_indices;
+
         [[nodiscard]] bool is_left_side_of_assignment(
                 const std::vector<const ::sqf::parser::sqf::bison::astnode *> &parent_nodes,
                 const ::sqf::parser::sqf::bison::astnode &node) const;
@@ -54,7 +57,15 @@ namespace sqfvm::language_server::analysis::sqf_ast::visitors {
                 std::string_view name,
                 bool is_declaration = false);
 
-        std::string push_scope(
+        uint64_t create_scope(
+                sqf_ast_analyzer &a,
+                std::optional<uint64_t> opt_parent_scope_id);
+
+        [[nodiscard]] bool is_same_or_parent_scope(
+                uint64_t parent_scope_id,
+                uint64_t scope_id) const;
+
+        uint64_t push_scope(
                 sqf_ast_analyzer &a,
                 const ::sqf::parser::sqf::bison::astnode &node,
                 const std::vector<const ::sqf::parser::sqf::bison::astnode *> &parent_nodes);
@@ -109,10 +120,6 @@ namespace sqfvm::language_server::analysis::sqf_ast::visitors {
                 const ::sqf::parser::sqf::bison::astnode &node,
                 const std::vector<const ::sqf::parser::sqf::bison::astnode *> &parent_nodes);
 
-        uint64_t file_id_of(
-                sqf_ast_analyzer &a,
-                const sqf::parser::sqf::bison::astnode &node);
-
     public:
         ~general_visitor() override = default;
 
@@ -3,7 +3,14 @@
 //
 
 #include "scripted_visitor.hpp"
+#include "../../../util.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
 #include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include "runtime/d_array.h"
 #include "runtime/d_string.h"
 #include "runtime/d_scalar.h"
@@ -14,8 +21,10 @@ using namespace ::sqf::types;
 using namespace ::sqfvm::language_server::database::tables;
 
 struct storage : public runtime::datastorage {
-    sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor *m_visitor;
-    sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer *m_ast_analyzer;
+    sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor *m_visitor = nullptr;
+    sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer *m_ast_analyzer = nullptr;
+    // The operators of the scripted analyzers are registered once per runtime, see scripted_visitor::start.
+    bool m_operators_registered = false;
 };
 
 namespace sqf {
@@ -31,13 +40,18 @@ namespace sqf {
         public:
             using data_type = sqf::runtime::t_scalar;
         private:
-            const sqf::parser::sqf::bison::astnode *m_node;
+            const sqf::parser::sqf::bison::astnode *m_node = nullptr;
+            // Index of the node in the parent nodes passed to enter and exit, equal to their size for the node itself.
+            // unknown_depth if the node was reached from a node whose depth is unknown.
+            size_t m_depth = unknown_depth;
         protected:
             bool do_equals(std::shared_ptr<data> other, bool invariant) const override {
                 return m_node == std::static_pointer_cast<d_astnode>(other)->m_node;
             }
 
         public:
+            static constexpr size_t unknown_depth = SIZE_MAX;
+
             d_astnode() = default;
 
             std::string to_string_sqf() const override {
@@ -52,6 +66,10 @@ namespace sqf {
 
             void node(const sqf::parser::sqf::bison::astnode &node) { m_node = &node; }
 
+            size_t depth() const { return m_depth; }
+
+            void depth(size_t depth) { m_depth = depth; }
+
             sqf::runtime::type type() const override { return data_type(); }
 
             virtual std::size_t hash() const override {
@@ -62,39 +80,202 @@ namespace sqf {
 
 }
 
+namespace {
+    // A script compiled by scripted_visitor::compiled_script_of, valid as long as the file keeps its last write time.
+    struct compiled_script {
+        std::filesystem::file_time_type last_write_time;
+        sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::script script;
+    };
+
+    // Everything the scripted analyzers read from disk, shared across all analyses of the process.
+    struct script_cache {
+        std::mutex mutex;
+        // Whether the use_scripted_analyzers marker exists, keyed by language server folder.
+        std::unordered_map<std::string, bool> enabled;
+        std::unordered_map<std::string, compiled_script> scripts;
+    };
+
+    script_cache &scripts() {
+        static script_cache cache;
+        return cache;
+    }
+}
+
 void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::start(
         sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer &a) {
     if (m_is_disabled)
         return;
     auto ls_path = ls_folder_of(a);
-    if (!exists(ls_path / "use_scripted_analyzers")) { // magic file to disable scripted analyzers
+    if (!is_enabled(ls_path)) {
         m_is_disabled = true;
         return;
     }
     auto base_path = ls_path / "scripted" / "analyzers" / "sqf";
-    if (!exists(base_path))
-        create_directories(base_path);
 
     auto runtime = runtime_of(a);
-    initialize_functions_and_documentation(a, runtime, base_path / "ReadMe.md");
-    initialize_start_script(runtime, base_path / "start.sqf");
-    initialize_enter_script(runtime, base_path / "enter.sqf");
-    initialize_exit_script(runtime, base_path / "exit.sqf");
-    initialize_end_script(runtime, base_path / "end.sqf");
-    initialize_analyze_script(runtime, base_path / "analyze.sqf");
+    // this is "dangerous" but we never leak the storage type into the runtime, so it should be fine
+    auto &s = runtime->storage<storage>();
+    s.m_visitor = this;
+    s.m_ast_analyzer = &a;
+    if (!s.m_operators_registered) {
+        register_operators(*runtime);
+        s.m_operators_registered = true;
+    }
+    // Scripts are parsed with the operators above registered, hence they may only be compiled afterwards.
+    m_start_script = compiled_script_of(*runtime, base_path / "start.sqf", "\n");
+    m_enter_script = compiled_script_of(*runtime, base_path / "enter.sqf", "params [\"_node\"];\n");
+    m_exit_script = compiled_script_of(*runtime, base_path / "exit.sqf", "params [\"_node\"];\n");
+    m_end_script = compiled_script_of(*runtime, base_path / "end.sqf", "\n");
+    m_analyze_script = compiled_script_of(*runtime, base_path / "analyze.sqf", "\n");
 
     call(runtime, m_start_script, {});
 }
 
-void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::initialize_functions_and_documentation(
-        sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer &a,
-        std::shared_ptr<sqf::runtime::runtime> runtime,
-        std::filesystem::path file) {
+bool sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::is_enabled(
+        const std::filesystem::path &ls_path) {
+    auto &cache = scripts();
+    std::lock_guard lock(cache.mutex);
+    auto key = ls_path.lexically_normal().string();
+    auto it = cache.enabled.find(key);
+    if (it != cache.enabled.end())
+        return it->second;
+    // magic file to disable scripted analyzers
+    auto enabled = exists(ls_path / "use_scripted_analyzers");
+    if (enabled) {
+        auto base_path = ls_path / "scripted" / "analyzers" / "sqf";
+        if (!exists(base_path))
+            create_directories(base_path);
+        write_documentation(base_path / "ReadMe.md");
+    }
+    cache.enabled.emplace(key, enabled);
+    return enabled;
+}
+
+void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::invalidate(
+        const std::filesystem::path &path) {
+    auto &cache = scripts();
+    std::lock_guard lock(cache.mutex);
+    auto prefix = path.lexically_normal().string();
+    std::erase_if(cache.enabled, [&](const auto &pair) {
+        // Dropping the marker state also rewrites a deleted ReadMe.md on the next analysis.
+        auto ls_path = std::filesystem::path(pair.first);
+        return (ls_path / "use_scripted_analyzers").string().starts_with(prefix)
+               || prefix.starts_with((ls_path / "scripted").string());
+    });
+    std::erase_if(cache.scripts, [&](const auto &pair) { return pair.first.starts_with(prefix); });
+}
+
+sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::script
+sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::compiled_script_of(
+        sqf::runtime::runtime &runtime,
+        const std::filesystem::path &file,
+        std::string_view default_contents) {
+    auto &cache = scripts();
+    std::lock_guard lock(cache.mutex);
+    auto key = file.lexically_normal().string();
+    std::error_code error_code;
+    auto last_write_time = std::filesystem::last_write_time(file, error_code);
+    auto it = cache.scripts.find(key);
+    if (!error_code && it != cache.scripts.end() && it->second.last_write_time == last_write_time)
+        return it->second.script;
+
+    if (error_code) {
+        {
+            auto f = std::ofstream(file);
+            f << default_contents;
+        }
+        last_write_time = std::filesystem::last_write_time(file, error_code);
+    }
+    // Failures are cached as well, so a broken script is only reported again once it changed.
+    auto &entry = cache.scripts[key];
+    entry.last_write_time = last_write_time;
+    entry.script = {};
+    auto contents = runtime.fileio().read_file_from_disk(file.string());
+    if (!contents) {
+        return {};
+    }
+    entry.script.filter = node_filter::parse(contents.value());
+    auto pp_result = runtime.parser_preprocessor().preprocess(
+            runtime,
+            contents.value(),
+            {file.string(), {}});
+    if (!pp_result) {
+        return {};
+    }
+    auto parse_result = runtime.parser_sqf().parse(
+            runtime,
+            pp_result.value(),
+            {file.string(), {}});
+    if (!parse_result) {
+        return {};
+    }
+    entry.script.instructions = std::move(parse_result);
+    return entry.script;
+}
+
+bool sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::node_filter::matches(
+        const sqf::parser::sqf::bison::astnode &node) const {
+    if (!kinds.empty()) {
+        auto kind = to_string_view(node.kind);
+        if (std::find(kinds.begin(), kinds.end(), kind) == kinds.end())
+            return false;
+    }
+    if (!operators.empty()) {
+        auto is_operator = [&](const std::string &name) { return iequal(name, node.token.contents); };
+        if (std::find_if(operators.begin(), operators.end(), is_operator) == operators.end())
+            return false;
+    }
+    return true;
+}
+
+sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::node_filter
+sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::node_filter::parse(
+        std::string_view contents) {
+    node_filter filter;
+    while (!contents.empty()) {
+        auto line_end = contents.find('\n');
+        auto line = contents.substr(0, line_end);
+        contents.remove_prefix(line_end == std::string_view::npos ? contents.size() : line_end + 1);
+        while (!line.empty() && std::isspace(static_cast<unsigned char>(line.front())))
+            line.remove_prefix(1);
+        if (line.empty())
+            continue;
+        if (!line.starts_with("//"))
+            break;
+        line.remove_prefix(2);
+        while (!line.empty() && std::isspace(static_cast<unsigned char>(line.front())))
+            line.remove_prefix(1);
+        std::vector<std::string> *target;
+        if (line.starts_with("@kinds")) {
+            target = &filter.kinds;
+            line.remove_prefix(6);
+        } else if (line.starts_with("@operators")) {
+            target = &filter.operators;
+            line.remove_prefix(10);
+        } else {
+            continue;
+        }
+        // Names are separated by whitespace or commas
+        auto is_separator = [](char c) { return c == ',' || std::isspace(static_cast<unsigned char>(c)); };
+        while (!line.empty()) {
+            auto start = std::find_if_not(line.begin(), line.end(), is_separator);
+            auto end = std::find_if(start, line.end(), is_separator);
+            if (start != end)
+                target->emplace_back(start, end);
+            line.remove_prefix(static_cast<size_t>(end - line.begin()));
+        }
+    }
+    return filter;
+}
+
+void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::write_documentation(
+        const std::filesystem::path &file) {
     if (!exists(file)) {
         auto f = std::ofstream(file);
         f << "<!-- TOC -->\n"
              "* [Welcome to scripted analyzers](#welcome-to-scripted-analyzers)\n"
              "* [What are scripted analyzers?](#what-are-scripted-analyzers)\n"
+             "* [Filtering nodes](#filtering-nodes)\n"
              "* [Data structures, types and enums](#data-structures-types-and-enums)\n"
              "  * [Enum: `SEVERITY`](#enum-severity)\n"
              "  * [Enum: `CODEACTIONKIND`](#enum-codeactionkind)\n"
@@ -116,6 +297,7 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
              "  * [Operator: `pathOf`](#operator-pathof)\n"
              "  * [Operator: `typeOf`](#operator-typeof)\n"
              "  * [Operator: `childrenOf`](#operator-childrenof)\n"
+             "  * [Operator: `parentOf`](#operator-parentof)\n"
              "  * [Operator: `fileOf`](#operator-fileof)\n"
              "  * [Operator: `reportDiagnostic`](#operator-reportdiagnostic)\n"
              "  * [Operator: `reportCodeAction`](#operator-reportcodeaction)\n"
@@ -133,6 +315,20 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
              "diagnostics. The analyzers are run on the server and the results are sent to\n"
              "the client, which will display them in the editor.\n"
              "\n"
+             "# Filtering nodes\n"
+             "\n"
+             "`enter.sqf` and `exit.sqf` are called for every node of the AST by default, which is slow.\n"
+             "To only receive the nodes you are interested in, start the script with comment lines\n"
+             "declaring the [Enum: `ASTNODETYPE`](#enum-astnodetype) values and operator names to match:\n"
+             "\n"
+             "```sqf\n"
+             "// @kinds EXPN EXPU\n"
+             "// @operators remoteExec, remoteExecCall\n"
+             "params [\"_node\"];\n"
+             "```\n"
+             "\n"
+             "A node has to match both lists, a missing list matches everything. Operator names ignore case.\n"
+             "\n"
              "# Data structures, types and enums\n"
              "\n"
              "The following are the data structures, types and enums that are available to the analyzers.\n"
@@ -487,6 +683,17 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
              "\n"
              "Returns the children (`[ASTNODE]`) of the given AST node.\n"
              "\n"
+             "## Operator: `parentOf`\n"
+             "\n"
+             "```sqf\n"
+             "parentOf ASTNODE\n"
+             "```\n"
+             "\n"
+             "Returns the parent ([Type: `ASTNODE`](#type-astnode)) of the given AST node or `nil` for the root.\n"
+             "Parents are only known while `enter.sqf` or `exit.sqf` is run for the node, one of its descendants\n"
+             "or its parent, hence they are known for the nodes returned by `childrenOf` on any of those.\n"
+             "Otherwise `nil` is returned as well.\n"
+             "\n"
              "## Operator: `fileOf`\n"
              "\n"
              "```sqf\n"
@@ -527,12 +734,11 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
              "Reports the given [Array: `HOVER`](#array-hover) to the client.\n";
         f.flush();
     }
+}
 
-    // this is "dangerous" but we never leak the storage type into the runtime, so it should be fine
-    auto &s = runtime->storage<storage>();
-    s.m_visitor = this;
-    s.m_ast_analyzer = &a;
-    runtime->register_sqfop(
+void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::register_operators(
+        sqf::runtime::runtime &runtime) {
+    runtime.register_sqfop(
             sqfop::unary(
                     "lineOf",
                     t_astnode(),
@@ -542,7 +748,7 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
                         return {d_node->node().token.line};
                     }
             ));
-    runtime->register_sqfop(
+    runtime.register_sqfop(
             sqfop::unary(
                     "columnOf",
                     t_astnode(),
@@ -552,7 +758,7 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
                         return {d_node->node().token.column};
                     }
             ));
-    runtime->register_sqfop(
+    runtime.register_sqfop(
             sqfop::unary(
                     "offsetOf",
                     t_astnode(),
@@ -562,7 +768,7 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
                         return {d_node->node().token.offset};
                     }
             ));
-    runtime->register_sqfop(
+    runtime.register_sqfop(
             sqfop::unary(
                     "contentOf",
                     t_astnode(),
@@ -573,7 +779,7 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
                                             d_node->node().token.contents.end())};
                     }
             ));
-    runtime->register_sqfop(
+    runtime.register_sqfop(
             sqfop::unary(
                     "pathOf",
                     t_astnode(),
@@ -583,7 +789,7 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
                         return {*d_node->node().token.path};
                     }
             ));
-    runtime->register_sqfop(
+    runtime.register_sqfop(
             sqfop::unary(
                     "typeOf",
                     t_astnode(),
@@ -594,25 +800,43 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
                         return {std::string(kind.begin(), kind.end())};
                     }
             ));
-    runtime->register_sqfop(
+    runtime.register_sqfop(
             sqfop::unary(
                     "childrenOf",
                     t_astnode(),
                     "Returns the children of the given AST node.",
                     [](auto &runtime, value::cref &right) -> sqf::runtime::value {
                         auto d_node = right.data<d_astnode>();
-                        auto children = d_node->node().children;
+                        const auto &children = d_node->node().children;
+                        auto depth = d_node->depth() == d_astnode::unknown_depth
+                                     ? d_astnode::unknown_depth
+                                     : d_node->depth() + 1;
                         std::vector<sqf::runtime::value> result;
                         result.reserve(children.size());
                         for (auto &child: children) {
                             auto ast_node = std::make_shared<d_astnode>();
                             ast_node->node(child);
+                            ast_node->depth(depth);
                             result.emplace_back(ast_node);
                         }
                         return {std::move(result)};
                     }
             ));
-    runtime->register_sqfop(
+    runtime.register_sqfop(
+            sqfop::unary(
+                    "parentOf",
+                    t_astnode(),
+                    "Returns the parent of the given AST node or nil if it is unknown.",
+                    [](sqf::runtime::runtime &runtime, value::cref &right) -> sqf::runtime::value {
+                        auto d_node = right.data<d_astnode>();
+                        auto &s = runtime.storage<storage>();
+                        auto parent = s.m_visitor->parent_of(*d_node);
+                        if (!parent)
+                            return {};
+                        return {parent};
+                    }
+            ));
+    runtime.register_sqfop(
             sqfop::unary(
                     "fileOf",
                     t_astnode(),
@@ -625,7 +849,7 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
                         return std::vector<value>{file.id_pk, file.path};
                     }
             ));
-    runtime->register_sqfop(
+    runtime.register_sqfop(
             sqfop::unary(
                     "reportDiagnostic",
                     t_array(),
@@ -692,7 +916,7 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
                         );
                         return {};
                     }));
-    runtime->register_sqfop(
+    runtime.register_sqfop(
             sqfop::binary(
                     4,
                     "reportCodeAction",
@@ -842,7 +1066,7 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
 
                         return {};
                     }));
-    runtime->register_sqfop(
+    runtime.register_sqfop(
             sqfop::unary(
                     "reportHover",
                     t_array(),
@@ -866,10 +1090,12 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
                         auto &s = runtime.template storage<storage>();
                         s.m_visitor->m_hovers.push_back(
                                 {
-                                        .start_line = start_line,
-                                        .start_column = start_column,
-                                        .end_line = end_line,
-                                        .end_column = end_column,
+                                        .hover = {
+                                                .start_line = start_line,
+                                                .start_column = start_column,
+                                                .end_line = end_line,
+                                                .end_column = end_column,
+                                        },
                                         .markdown = markdown
                                 }
                         );
@@ -877,179 +1103,74 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::init
                     }));
 }
 
-void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::initialize_start_script(
-        std::shared_ptr<sqf::runtime::runtime> runtime,
-        std::filesystem::path file) {
-    if (!exists(file)) {
-        auto f = std::ofstream(file);
-        f << std::endl;
-    }
-    auto contents = runtime->fileio().read_file_from_disk(file.string());
-    if (!contents) {
-        return;
-    }
-    auto pp_result = runtime->parser_preprocessor().preprocess(
-            *runtime,
-            contents.value(),
-            {file.string(), {}});
-    if (!pp_result) {
-        return;
-    }
-    auto parse_result = runtime->parser_sqf().parse(
-            *runtime,
-            pp_result.value(),
-            {file.string(), {}});
-    if (!parse_result) {
-        return;
-    }
-    m_start_script = std::move(parse_result);
-}
-
-void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::initialize_enter_script(
-        std::shared_ptr<sqf::runtime::runtime> runtime,
-        std::filesystem::path file) {
-    if (!exists(file)) {
-        auto f = std::ofstream(file);
-        f << "params [\"_node\", \"_parents\"];" << std::endl;
-    }
-    auto contents = runtime->fileio().read_file_from_disk(file.string());
-    if (!contents) {
-        return;
-    }
-    auto pp_result = runtime->parser_preprocessor().preprocess(
-            *runtime,
-            contents.value(),
-            {file.string(), {}});
-    if (!pp_result) {
-        return;
-    }
-    auto parse_result = runtime->parser_sqf().parse(
-            *runtime,
-            pp_result.value(),
-            {file.string(), {}});
-    if (!parse_result) {
-        return;
-    }
-    m_start_script = std::move(parse_result);
+std::shared_ptr<d_astnode> sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::node_handle(
+        size_t depth,
+        const sqf::parser::sqf::bison::astnode &node) {
+    if (m_node_handles.size() <= depth)
+        m_node_handles.resize(depth + 1);
+    auto &handle = m_node_handles[depth];
+    // Handles still referred to by a script have to keep their node, everything else is reused.
+    if (!handle || (handle.use_count() > 1 && &handle->node() != &node))
+        handle = std::make_shared<d_astnode>();
+    handle->node(node);
+    handle->depth(depth);
+    return handle;
 }
 
-void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::initialize_exit_script(
-        std::shared_ptr<sqf::runtime::runtime> runtime,
-        std::filesystem::path file) {
-    if (!exists(file)) {
-        auto f = std::ofstream(file);
-        f << "params [\"_node\", \"_parents\"];" << std::endl;
-    }
-    auto contents = runtime->fileio().read_file_from_disk(file.string());
-    if (!contents) {
-        return;
-    }
-    auto pp_result = runtime->parser_preprocessor().preprocess(
-            *runtime,
-            contents.value(),
-            {file.string(), {}});
-    if (!pp_result) {
-        return;
-    }
-    auto parse_result = runtime->parser_sqf().parse(
-            *runtime,
-            pp_result.value(),
-            {file.string(), {}});
-    if (!parse_result) {
-        return;
-    }
-    m_start_script = std::move(parse_result);
+std::shared_ptr<d_astnode> sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::parent_of(
+        const d_astnode &node) {
+    // Nodes at depth parents.size() + 1 can only be children of the visited node, returned by childrenOf.
+    if (m_parent_nodes == nullptr || node.depth() == 0 || node.depth() == d_astnode::unknown_depth
+        || node.depth() > m_parent_nodes->size() + 1)
+        return {};
+    auto &parents = *m_parent_nodes;
+    auto path_node = [&](size_t depth) -> const sqf::parser::sqf::bison::astnode * {
+        return depth < parents.size() ? parents[depth] : depth == parents.size() ? m_current_node : nullptr;
+    };
+    auto parent = path_node(node.depth() - 1);
+    if (parent == nullptr)
+        return {};
+    // The node either is on the path to the visited node or is a child of a node on it
+    auto &children = parent->children;
+    auto is_child = !children.empty()
+                    && &node.node() >= children.data()
+                    && &node.node() < children.data() + children.size();
+    if (path_node(node.depth()) != &node.node() && !is_child)
+        return {};
+    return node_handle(node.depth() - 1, *parent);
 }
 
-void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::initialize_end_script(
-        std::shared_ptr<sqf::runtime::runtime> runtime,
-        std::filesystem::path file) {
-    if (!exists(file)) {
-        auto f = std::ofstream(file);
-        f << std::endl;
-    }
-    auto contents = runtime->fileio().read_file_from_disk(file.string());
-    if (!contents) {
-        return;
-    }
-    auto pp_result = runtime->parser_preprocessor().preprocess(
-            *runtime,
-            contents.value(),
-            {file.string(), {}});
-    if (!pp_result) {
-        return;
-    }
-    auto parse_result = runtime->parser_sqf().parse(
-            *runtime,
-            pp_result.value(),
-            {file.string(), {}});
-    if (!parse_result) {
-        return;
-    }
-    m_start_script = std::move(parse_result);
-}
-
-void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::initialize_analyze_script(
-        std::shared_ptr<sqf::runtime::runtime> runtime,
-        std::filesystem::path file) {
-    if (!exists(file)) {
-        auto f = std::ofstream(file);
-        f << std::endl;
-    }
-    auto contents = runtime->fileio().read_file_from_disk(file.string());
-    if (!contents) {
-        return;
-    }
-    auto pp_result = runtime->parser_preprocessor().preprocess(
-            *runtime,
-            contents.value(),
-            {file.string(), {}});
-    if (!pp_result) {
-        return;
-    }
-    auto parse_result = runtime->parser_sqf().parse(
-            *runtime,
-            pp_result.value(),
-            {file.string(), {}});
-    if (!parse_result) {
+void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::visit(
+        sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer &a,
+        const script &target,
+        const sqf::parser::sqf::bison::astnode &node,
+        const std::vector<const ::sqf::parser::sqf::bison::astnode *> &parent_nodes) {
+    if (!target.instructions.has_value() || !target.filter.matches(node))
         return;
-    }
-    m_start_script = std::move(parse_result);
+    m_current_node = &node;
+    m_parent_nodes = &parent_nodes;
+    call(runtime_of(a), target, {node_handle(parent_nodes.size(), node)});
+    m_current_node = nullptr;
+    m_parent_nodes = nullptr;
 }
 
 void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::enter(
         sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer &a,
         const sqf::parser::sqf::bison::astnode &node,
         const std::vector<const ::sqf::parser::sqf::bison::astnode *> &parent_nodes) {
-    auto d_node = std::make_shared<d_astnode>();
-    d_node->node(node);
-    auto d_parent_nodes = std::make_shared<d_array>();
-    for (auto &p: parent_nodes) {
-        auto d_p = std::make_shared<d_astnode>();
-        d_p->node(*p);
-        d_parent_nodes->push_back(d_p);
-    }
-    call(runtime_of(a), m_enter_script, {d_node, d_parent_nodes});
+    visit(a, m_enter_script, node, parent_nodes);
 }
 
 void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::exit(
         sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer &a,
         const sqf::parser::sqf::bison::astnode &node,
         const std::vector<const ::sqf::parser::sqf::bison::astnode *> &parent_nodes) {
-    auto d_node = std::make_shared<d_astnode>();
-    d_node->node(node);
-    auto d_parent_nodes = std::make_shared<d_array>();
-    for (auto &p: parent_nodes) {
-        auto d_p = std::make_shared<d_astnode>();
-        d_p->node(*p);
-        d_parent_nodes->push_back(d_p);
-    }
-    call(runtime_of(a), m_exit_script, {d_node, d_parent_nodes});
+    visit(a, m_exit_script, node, parent_nodes);
 }
 
 void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::end(
         sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer &a) {
-    call(runtime_of(a), m_exit_script, {});
+    call(runtime_of(a), m_end_script, {});
 }
 
 void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::analyze(
@@ -1061,19 +1182,25 @@ void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::anal
 
 void sqfvm::language_server::analysis::sqf_ast::visitors::scripted_visitor::call(
         std::shared_ptr<sqf::runtime::runtime> runtime,
-        std::optional<::sqf::runtime::instruction_set> &instruction_set,
+        const script &target,
         std::vector<value> this_values) {
-    if (!instruction_set.has_value())
-        return;
-    auto &is = instruction_set.value();
-    auto context_weak = runtime->context_create();
-    auto context = context_weak.lock();
-    if (!context)
+    if (!target.instructions.has_value())
         return;
+    auto &is = target.instructions.value();
+    // The context is reused for all calls of this analysis, a new one is only created if the runtime dropped it.
+    auto context = m_context.lock();
+    if (!context) {
+        m_context = runtime->context_create();
+        context = m_context.lock();
+        if (!context)
+            return;
+    }
     sqf::runtime::frame f(runtime->default_value_scope(), is);
     f["_this"] = {this_values};
     context->push_frame(f);
     auto result = runtime->execute(sqf::runtime::runtime::action::start);
-    if (result != sqf::runtime::runtime::result::ok)
+    if (result != sqf::runtime::runtime::result::ok) {
         runtime->context_remove(context);
+        m_context.reset();
+    }
 }
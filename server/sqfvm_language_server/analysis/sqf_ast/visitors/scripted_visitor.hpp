@@ -8,35 +8,87 @@
 
 #include "../ast_visitor.hpp"
 
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sqf::types {
+    class d_astnode;
+}
+
 namespace sqfvm::language_server::analysis::sqf_ast::visitors {
     class scripted_visitor : public ast_visitor {
-        bool m_is_disabled;
-        std::optional<::sqf::runtime::instruction_set> m_start_script;
-        std::optional<::sqf::runtime::instruction_set> m_enter_script;
-        std::optional<::sqf::runtime::instruction_set> m_exit_script;
-        std::optional<::sqf::runtime::instruction_set> m_end_script;
-        std::optional<::sqf::runtime::instruction_set> m_analyze_script;
+    public:
+        // The nodes enter.sqf and exit.sqf are called for, declared by comment lines at the top of the script:
+        //     // @kinds EXPN EXPU
+        //     // @operators remoteExec remoteExecCall
+        // A node has to match both lists, an empty list matches everything. Operator names ignore case.
+        struct node_filter {
+            std::vector<std::string> kinds;
+            std::vector<std::string> operators;
+
+            [[nodiscard]] bool matches(const ::sqf::parser::sqf::bison::astnode &node) const;
+
+            // Reads the filter from the leading comment lines of the given script contents.
+            [[nodiscard]] static node_filter parse(std::string_view contents);
+        };
+
+        struct script {
+            std::optional<::sqf::runtime::instruction_set> instructions;
+            node_filter filter;
+        };
+
+    private:
+        bool m_is_disabled = false;
+        script m_start_script;
+        script m_enter_script;
+        script m_exit_script;
+        script m_end_script;
+        script m_analyze_script;
+        std::weak_ptr<::sqf::runtime::context> m_context;
+
+        // Handles passed to the scripts, one per depth of the AST, reused as long as no script holds on to them.
+        std::vector<std::shared_ptr<::sqf::types::d_astnode>> m_node_handles;
+        // The node and its parent nodes currently visited by enter or exit, to resolve parentOf.
+        const ::sqf::parser::sqf::bison::astnode *m_current_node = nullptr;
+        const std::vector<const ::sqf::parser::sqf::bison::astnode *> *m_parent_nodes = nullptr;
 
 
-        void initialize_functions_and_documentation(
-                sqfvm::language_server::analysis::sqf_ast::sqf_ast_analyzer &a,
-                std::shared_ptr<sqf::runtime::runtime> right,
-                std::filesystem::path file);
+        static bool is_enabled(const std::filesystem::path &ls_path);
 
-        void initialize_start_script(std::shared_ptr<sqf::runtime::runtime> runtime, std::filesystem::path file);
+        static void write_documentation(const std::filesystem::path &file);
+
+        static void register_operators(sqf::runtime::runtime &runtime);
+
+        std::shared_ptr<::sqf::types::d_astnode> node_handle(
+                size_t depth,
+                const ::sqf::parser::sqf::bison::astnode &node);
+
+        // Returns the handle of the parent of the given node, as long as it is part of the nodes currently visited.
+        std::shared_ptr<::sqf::types::d_astnode> parent_of(const ::sqf::types::d_astnode &node);
+
+        void visit(
+                sqf_ast_analyzer &a,
+                const script &target,
+                const ::sqf::parser::sqf::bison::astnode &node,
+                const std::vector<const ::sqf::parser::sqf::bison::astnode *> &parent_nodes);
 
         void call(
                 std::shared_ptr<sqf::runtime::runtime> runtime,
-                std::optional<::sqf::runtime::instruction_set> &instruction_set,
+                const script &target,
                 std::vector<sqf::runtime::value> this_values);
 
-        void initialize_enter_script(std::shared_ptr<sqf::runtime::runtime> runtime, std::filesystem::path file);
-
-        void initialize_exit_script(std::shared_ptr<sqf::runtime::runtime> runtime, std::filesystem::path file);
+        // Returns the compiled contents of the given script, creating it with default_contents if it does not exist.
+        // Compiled scripts are shared across all analyses until the script is changed on disk.
+        static script compiled_script_of(
+                sqf::runtime::runtime &runtime,
+                const std::filesystem::path &file,
+                std::string_view default_contents);
 
-        void initialize_end_script(std::shared_ptr<sqf::runtime::runtime> runtime, std::filesystem::path file);
-
-        void initialize_analyze_script(std::shared_ptr<sqf::runtime::runtime> runtime, std::filesystem::path file);
+    public:
+        // Drops everything cached about the given path (file or directory), so it is re-read on the next analysis.
+        // Has to be called for every change inside of the language server folder.
+        static void invalidate(const std::filesystem::path &path);
 
     public:
         ~scripted_visitor() override = default;
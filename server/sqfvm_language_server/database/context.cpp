@@ -3,6 +3,9 @@
 //
 #include "context.hpp"
 
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
 #include <utility>
 #include "../util.hpp"
 
@@ -12,11 +15,17 @@ using namespace ::sqfvm::language_server::database::tables;
 void sqfvm::language_server::database::context::db_clear() {
     m_storage.remove_all<internal::t_db_generation>();
     m_storage.remove_all<t_diagnostic>();
+    m_storage.remove_all<t_config_function>();
+    m_storage.remove_all<t_config_property>();
+    m_storage.remove_all<t_config_class>();
     m_storage.remove_all<t_reference>();
     m_storage.remove_all<t_variable>();
+    m_storage.remove_all<t_scope>();
     m_storage.remove_all<t_code_action_change>();
     m_storage.remove_all<t_code_action>();
     m_storage.remove_all<t_hover>();
+    m_storage.remove_all<t_hover_content>();
+    m_storage.remove_all<t_folding_range>();
     m_storage.remove_all<t_file_include>();
     m_storage.remove_all<t_file_history>();
     m_storage.remove_all<t_file>();
@@ -89,6 +98,36 @@ namespace {
         }
     }
 
+    // sqlite_orm offers no way to run arbitrary PRAGMA's or VACUUM variants, hence those go to SQLite directly.
+    void exec_sql(sqlite3 *db, const std::string &sql) {
+        char *error = nullptr;
+        if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &error) != SQLITE_OK) {
+            std::string message = error ? error : sqlite3_errmsg(db);
+            sqlite3_free(error);
+            throw std::runtime_error(message);
+        }
+    }
+
+    int64_t query_int64(sqlite3 *db, const std::string &sql) {
+        sqlite3_stmt *stmt = nullptr;
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+            throw std::runtime_error(sqlite3_errmsg(db));
+        int64_t result = 0;
+        if (sqlite3_step(stmt) == SQLITE_ROW)
+            result = sqlite3_column_int64(stmt, 0);
+        sqlite3_finalize(stmt);
+        return result;
+    }
+
+    template<typename T>
+    context::table_statistics row_count_of(context::storage_t &orm) {
+        return context::table_statistics{
+                .name = T::table_name,
+                .rows = static_cast<uint64_t>(orm.count<T>()),
+                .bytes = std::nullopt,
+        };
+    }
+
     template<typename T>
     nlohmann::json to_json(const T &t) {
         return nlohmann::json(t);
@@ -112,7 +151,9 @@ namespace {
                 {"id_pk",          t.id_pk},
                 {"variable_name",  t.variable_name},
                 {"scope",          t.scope},
-                {"opt_file_fk",    t.opt_file_fk.has_value() ? nlohmann::json(nullptr) : nlohmann::json(t.opt_file_fk.value())}
+                {"opt_file_fk",    t.opt_file_fk.has_value() ? nlohmann::json(t.opt_file_fk.value()) : nlohmann::json(nullptr)},
+                {"opt_scope_fk",   t.opt_scope_fk.has_value() ? nlohmann::json(t.opt_scope_fk.value()) : nlohmann::json(nullptr)},
+                {"types",          static_cast<int>(t.types)}
         };
     }
     template<>
@@ -291,6 +332,64 @@ std::pair<context::operations::success_t, std::vector<tables::t_reference>> cont
     }
 }
 
+std::pair<context::operations::success_t, std::vector<t_config_class>>
+context::operations::find_config_classes_by_path(
+        context &self,
+        const context::operations::errlogfnc_t &fnc,
+        const std::string &path) {
+    return log_on_error_or_pair<std::vector<t_config_class>>(
+            fnc,
+            [&]() -> std::vector<t_config_class> {
+                auto &orm = self.storage();
+                return orm.get_all<t_config_class>(where(c(&t_config_class::path) == path));
+            },
+            [&](auto &sstream) {
+                sstream << "find_config_classes_by_path(\n"
+                        << "    path: " << path << "\n"
+                        << ")";
+            });
+}
+
+std::pair<context::operations::success_t, std::vector<t_config_class>>
+context::operations::find_config_classes_by_file_and_base_line(
+        context &self,
+        const context::operations::errlogfnc_t &fnc,
+        uint64_t file_id,
+        uint64_t base_line) {
+    return log_on_error_or_pair<std::vector<t_config_class>>(
+            fnc,
+            [&]() -> std::vector<t_config_class> {
+                auto &orm = self.storage();
+                return orm.get_all<t_config_class>(
+                        where(c(&t_config_class::file_fk) == file_id
+                              && c(&t_config_class::base_line) == base_line));
+            },
+            [&](auto &sstream) {
+                sstream << "find_config_classes_by_file_and_base_line(\n"
+                        << "    file_id: " << file_id << ",\n"
+                        << "    base_line: " << base_line << "\n"
+                        << ")";
+            });
+}
+
+std::pair<context::operations::success_t, std::vector<t_config_function>>
+context::operations::find_config_functions_by_name(
+        context &self,
+        const context::operations::errlogfnc_t &fnc,
+        const std::string &name) {
+    return log_on_error_or_pair<std::vector<t_config_function>>(
+            fnc,
+            [&]() -> std::vector<t_config_function> {
+                auto &orm = self.storage();
+                return orm.get_all<t_config_function>(where(c(&t_config_function::name) == name));
+            },
+            [&](auto &sstream) {
+                sstream << "find_config_functions_by_name(\n"
+                        << "    name: " << name << "\n"
+                        << ")";
+            });
+}
+
 std::pair<context::operations::success_t, std::vector<tables::t_reference>> context::operations::get_all_variables_of_variable(
         context &self,
         const context::operations::errlogfnc_t &fnc,
@@ -350,4 +449,132 @@ context::operations::success_t context::operations::insert(
             });
 }
 
-#pragma endregion
\ No newline at end of file
+std::pair<context::operations::success_t, bool> context::operations::enable_incremental_vacuum(
+        context &self,
+        const context::operations::errlogfnc_t &fnc) {
+    bool converted = false;
+    auto success = log_on_error_or_true(
+            fnc,
+            [&]() {
+                auto &orm = self.storage();
+                // Keeps a single connection open for all statements, as the PRAGMA's are connection-bound.
+                auto connection = orm.get_connection();
+                auto db = connection.get();
+
+                // auto_vacuum only takes effect after a full VACUUM, which hence is done once per database.
+                if (query_int64(db, "PRAGMA auto_vacuum") == 2)
+                    return;
+                exec_sql(db, "PRAGMA auto_vacuum = INCREMENTAL");
+                exec_sql(db, "VACUUM");
+                converted = true;
+            }, [&](auto &sstream) {
+                sstream << "enable_incremental_vacuum()";
+            });
+    return std::make_pair(success, converted);
+}
+
+std::pair<context::operations::success_t, context::maintenance_result> context::operations::run_maintenance(
+        context &self,
+        const context::operations::errlogfnc_t &fnc) {
+    maintenance_result result{};
+    auto success = log_on_error_or_true(
+            fnc,
+            [&]() {
+                auto &orm = self.storage();
+                // Keeps a single connection open for all statements, as the PRAGMA's are connection-bound.
+                auto connection = orm.get_connection();
+                auto db = connection.get();
+
+                // Globals are never removed during a commit, as other files might still refer to them.
+                auto variables_before = orm.count<t_variable>();
+                orm.remove_all<t_variable>(
+                        where(is_null(&t_variable::opt_scope_fk)
+                              and not_in(&t_variable::id_pk, select(&t_reference::variable_fk))));
+                result.removed_variables = static_cast<uint64_t>(variables_before - orm.count<t_variable>());
+
+                auto hover_contents_before = orm.count<t_hover_content>();
+                orm.remove_all<t_hover_content>(
+                        where(not_in(&t_hover_content::id_pk, select(&t_hover::content_fk))));
+                result.removed_hover_contents = static_cast<uint64_t>(
+                        hover_contents_before - orm.count<t_hover_content>());
+
+                // Free pages can only be released once enable_incremental_vacuum converted the database.
+                if (query_int64(db, "PRAGMA auto_vacuum") == 2) {
+                    auto free_pages = static_cast<uint64_t>(query_int64(db, "PRAGMA freelist_count"));
+                    result.vacuumed_pages = std::min(free_pages, incremental_vacuum_pages);
+                    if (result.vacuumed_pages > 0)
+                        exec_sql(db, "PRAGMA incremental_vacuum(" + std::to_string(result.vacuumed_pages) + ")");
+                }
+
+                // analysis_limit makes ANALYZE sample instead of scanning every index completely.
+                exec_sql(db, "PRAGMA analysis_limit = 1000");
+                exec_sql(db, "ANALYZE");
+                exec_sql(db, "PRAGMA optimize");
+            }, [&](auto &sstream) {
+                sstream << "run_maintenance()";
+            });
+    return std::make_pair(success, result);
+}
+
+std::pair<context::operations::success_t, context::database_statistics> context::operations::get_statistics(
+        context &self,
+        const context::operations::errlogfnc_t &fnc) {
+    database_statistics result{};
+    auto success = log_on_error_or_true(
+            fnc,
+            [&]() {
+                auto &orm = self.storage();
+                auto connection = orm.get_connection();
+                auto db = connection.get();
+                result.tables = {
+                        row_count_of<t_file>(orm),
+                        row_count_of<t_file_history>(orm),
+                        row_count_of<t_file_include>(orm),
+                        row_count_of<t_variable>(orm),
+                        row_count_of<t_scope>(orm),
+                        row_count_of<t_reference>(orm),
+                        row_count_of<t_diagnostic>(orm),
+                        row_count_of<t_hover>(orm),
+                        row_count_of<t_hover_content>(orm),
+                        row_count_of<t_folding_range>(orm),
+                        row_count_of<t_code_action>(orm),
+                        row_count_of<t_code_action_change>(orm),
+                        row_count_of<t_config_class>(orm),
+                        row_count_of<t_config_property>(orm),
+                        row_count_of<t_config_function>(orm),
+                };
+
+                auto page_size = static_cast<uint64_t>(query_int64(db, "PRAGMA page_size"));
+                result.file_bytes = page_size * static_cast<uint64_t>(query_int64(db, "PRAGMA page_count"));
+                result.free_bytes = page_size * static_cast<uint64_t>(query_int64(db, "PRAGMA freelist_count"));
+
+                // Attributes the pages of every index to the table it belongs to.
+                sqlite3_stmt *stmt = nullptr;
+                if (sqlite3_prepare_v2(
+                        db,
+                        "SELECT m.tbl_name, SUM(s.pgsize) FROM dbstat s"
+                        " JOIN sqlite_master m ON m.name = s.name GROUP BY m.tbl_name",
+                        -1,
+                        &stmt,
+                        nullptr) != SQLITE_OK) {
+                    sqlite3_finalize(stmt);
+                    return;
+                }
+                std::unordered_map<std::string, uint64_t> bytes;
+                while (sqlite3_step(stmt) == SQLITE_ROW) {
+                    auto name = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+                    if (name)
+                        bytes[name] = static_cast<uint64_t>(sqlite3_column_int64(stmt, 1));
+                }
+                sqlite3_finalize(stmt);
+                for (auto &table: result.tables) {
+                    auto it = bytes.find(table.name);
+                    table.bytes = it == bytes.end() ? 0 : it->second;
+                }
+            }, [&](auto &sstream) {
+                sstream << "get_statistics()";
+            });
+    return std::make_pair(success, result);
+}
+
+#pragma endregion
@@ -7,11 +7,17 @@
 #include <sqlite_orm/sqlite_orm.h>
 #include "tables/t_code_action.h"
 #include "tables/t_code_action_change.h"
+#include "tables/t_config_class.h"
+#include "tables/t_config_function.h"
+#include "tables/t_config_property.h"
 #include "tables/t_diagnostic.h"
+#include "tables/t_folding_range.h"
 #include "tables/t_hover.h"
+#include "tables/t_hover_content.h"
 #include "tables/t_file.h"
 #include "tables/t_file_history.h"
 #include "tables/t_reference.h"
+#include "tables/t_scope.h"
 #include "tables/t_variable.h"
 #include "orm_mappings.hpp"
 #include "tables/t_file_include.h"
@@ -21,7 +27,7 @@ namespace sqfvm::language_server::database {
     namespace internal {
         struct t_db_generation {
             static constexpr const char *table_name = "tDbGeneration";
-            static const int expected_generation = 11;
+            static const int expected_generation = 17;
             int id_pk;
             int generation;
         };
@@ -49,8 +55,23 @@ namespace sqfvm::language_server::database {
                                make_column("start_column", &t_hover::start_column),
                                make_column("end_line", &t_hover::end_line),
                                make_column("end_column", &t_hover::end_column),
-                               make_column("markdown", &t_hover::markdown),
-                               foreign_key(&t_hover::file_fk).references(&t_file::id_pk)),
+                               make_column("content_fk", &t_hover::content_fk),
+                               foreign_key(&t_hover::file_fk).references(&t_file::id_pk),
+                               foreign_key(&t_hover::content_fk).references(&t_hover_content::id_pk)),
+                    make_index("idx_tHover_content_fk", &t_hover::content_fk),
+                    make_table(t_hover_content::table_name,
+                               make_column("id_pk", &t_hover_content::id_pk, primary_key().autoincrement()),
+                               make_column("hash", &t_hover_content::hash),
+                               make_column("markdown", &t_hover_content::markdown)),
+                    make_index("idx_tHoverContent_hash", &t_hover_content::hash),
+                    make_table(t_folding_range::table_name,
+                               make_column("id_pk", &t_folding_range::id_pk, primary_key().autoincrement()),
+                               make_column("file_fk", &t_folding_range::file_fk),
+                               make_column("start_line", &t_folding_range::start_line),
+                               make_column("end_line", &t_folding_range::end_line),
+                               make_column("kind", &t_folding_range::kind),
+                               foreign_key(&t_folding_range::file_fk).references(&t_file::id_pk)),
+                    make_index("idx_tFoldingRange_file_fk", &t_folding_range::file_fk),
                     make_table(t_file_history::table_name,
                                make_column("id_pk", &t_file_history::id_pk, primary_key().autoincrement()),
                                make_column("file_fk", &t_file_history::file_fk),
@@ -99,12 +120,25 @@ namespace sqfvm::language_server::database {
                                make_column("is_magic_variable", &t_reference::is_magic_variable),
                                foreign_key(&t_reference::file_fk).references(&t_file::id_pk),
                                foreign_key(&t_reference::variable_fk).references(&t_variable::id_pk)),
+                    make_table(t_scope::table_name,
+                               make_column("id_pk", &t_scope::id_pk, primary_key().autoincrement()),
+                               make_column("file_fk", &t_scope::file_fk),
+                               make_column("opt_parent_scope_fk", &t_scope::opt_parent_scope_fk),
+                               make_column("ordinal", &t_scope::ordinal),
+                               foreign_key(&t_scope::file_fk).references(&t_file::id_pk),
+                               foreign_key(&t_scope::opt_parent_scope_fk).references(&t_scope::id_pk)),
+                    make_index("idx_tScope_file_fk", &t_scope::file_fk),
                     make_table(t_variable::table_name,
                                make_column("id_pk", &t_variable::id_pk, primary_key().autoincrement()),
                                make_column("variable_name", &t_variable::variable_name),
                                make_column("scope", &t_variable::scope),
                                make_column("opt_file_fk", &t_variable::opt_file_fk),
-                               foreign_key(&t_variable::opt_file_fk).references(&t_file::id_pk)),
+                               make_column("opt_scope_fk", &t_variable::opt_scope_fk),
+                               make_column("types", &t_variable::types),
+                               foreign_key(&t_variable::opt_file_fk).references(&t_file::id_pk),
+                               foreign_key(&t_variable::opt_scope_fk).references(&t_scope::id_pk)),
+                    make_index("idx_tVariable_opt_file_fk", &t_variable::opt_file_fk),
+                    make_index("idx_tVariable_scope_variable_name", &t_variable::scope, &t_variable::variable_name),
                     make_table(t_diagnostic::table_name,
                                make_column("id_pk", &t_diagnostic::id_pk, primary_key().autoincrement()),
                                make_column("file_fk", &t_diagnostic::file_fk),
@@ -119,7 +153,56 @@ namespace sqfvm::language_server::database {
                                make_column("length", &t_diagnostic::length),
                                make_column("is_suppressed", &t_diagnostic::is_suppressed),
                                foreign_key(&t_diagnostic::source_file_fk).references(&t_file::id_pk),
-                               foreign_key(&t_diagnostic::file_fk).references(&t_file::id_pk)));
+                               foreign_key(&t_diagnostic::file_fk).references(&t_file::id_pk)),
+                    make_table(t_config_class::table_name,
+                               make_column("id_pk", &t_config_class::id_pk, primary_key().autoincrement()),
+                               make_column("file_fk", &t_config_class::file_fk),
+                               make_column("source_file_fk", &t_config_class::source_file_fk),
+                               make_column("name", &t_config_class::name),
+                               make_column("path", &t_config_class::path),
+                               make_column("parent_path", &t_config_class::parent_path),
+                               make_column("base_name", &t_config_class::base_name),
+                               make_column("opt_base_path", &t_config_class::opt_base_path),
+                               make_column("line", &t_config_class::line),
+                               make_column("column", &t_config_class::column),
+                               make_column("offset", &t_config_class::offset),
+                               make_column("base_line", &t_config_class::base_line),
+                               make_column("base_column", &t_config_class::base_column),
+                               foreign_key(&t_config_class::file_fk).references(&t_file::id_pk),
+                               foreign_key(&t_config_class::source_file_fk).references(&t_file::id_pk)),
+                    make_index("idx_tConfigClass_path", &t_config_class::path),
+                    make_index("idx_tConfigClass_file_fk", &t_config_class::file_fk),
+                    make_index("idx_tConfigClass_source_file_fk", &t_config_class::source_file_fk),
+                    make_table(t_config_property::table_name,
+                               make_column("id_pk", &t_config_property::id_pk, primary_key().autoincrement()),
+                               make_column("file_fk", &t_config_property::file_fk),
+                               make_column("source_file_fk", &t_config_property::source_file_fk),
+                               make_column("class_path", &t_config_property::class_path),
+                               make_column("name", &t_config_property::name),
+                               make_column("value", &t_config_property::value),
+                               make_column("is_append", &t_config_property::is_append),
+                               make_column("line", &t_config_property::line),
+                               make_column("column", &t_config_property::column),
+                               make_column("offset", &t_config_property::offset),
+                               foreign_key(&t_config_property::file_fk).references(&t_file::id_pk),
+                               foreign_key(&t_config_property::source_file_fk).references(&t_file::id_pk)),
+                    make_index("idx_tConfigProperty_class_path", &t_config_property::class_path),
+                    make_index("idx_tConfigProperty_source_file_fk", &t_config_property::source_file_fk),
+                    make_table(t_config_function::table_name,
+                               make_column("id_pk", &t_config_function::id_pk, primary_key().autoincrement()),
+                               make_column("file_fk", &t_config_function::file_fk),
+                               make_column("source_file_fk", &t_config_function::source_file_fk),
+                               make_column("name", &t_config_function::name, collate_nocase()),
+                               make_column("path", &t_config_function::path),
+                               make_column("opt_target_file_fk", &t_config_function::opt_target_file_fk),
+                               make_column("line", &t_config_function::line),
+                               make_column("column", &t_config_function::column),
+                               foreign_key(&t_config_function::file_fk).references(&t_file::id_pk),
+                               foreign_key(&t_config_function::source_file_fk).references(&t_file::id_pk),
+                               foreign_key(&t_config_function::opt_target_file_fk).references(&t_file::id_pk)),
+                    make_index("idx_tConfigFunction_name", &t_config_function::name),
+                    make_index("idx_tConfigFunction_opt_target_file_fk", &t_config_function::opt_target_file_fk),
+                    make_index("idx_tConfigFunction_source_file_fk", &t_config_function::source_file_fk));
             return storage;
         }
     }
@@ -228,11 +311,34 @@ namespace sqfvm::language_server::database {
 
         void db_clear();
 
+        // Size of a single table, including its indices.
+        struct table_statistics {
+            std::string name;
+            uint64_t rows;
+            // Empty if SQLite was compiled without the dbstat virtual table.
+            std::optional<uint64_t> bytes;
+        };
+
+        struct database_statistics {
+            std::vector<table_statistics> tables;
+            uint64_t file_bytes;
+            uint64_t free_bytes;
+        };
+
+        struct maintenance_result {
+            uint64_t removed_variables;
+            uint64_t removed_hover_contents;
+            uint64_t vacuumed_pages;
+        };
+
         struct operations {
             using errlogfnc_t = std::function<void(const std::string &)>;
             using success_t = bool;
             using abort_t = bool;
 
+            // Amount of free pages released per maintenance run.
+            static constexpr uint64_t incremental_vacuum_pages = 2048;
+
             [[nodiscard]] static success_t mark_all_files_as_deleted(
                     context &self,
                     const errlogfnc_t &fnc);
@@ -290,6 +396,24 @@ namespace sqfvm::language_server::database {
                     uint64_t line,
                     bool exclude_magical);
 
+            [[nodiscard]] static std::pair<success_t, std::vector<tables::t_config_class>> find_config_classes_by_path(
+                    context &self,
+                    const context::operations::errlogfnc_t &fnc,
+                    const std::string &path);
+
+            // Returns the config classes of the given file whose base_name is located at the given 1-based line.
+            [[nodiscard]] static std::pair<success_t, std::vector<tables::t_config_class>> find_config_classes_by_file_and_base_line(
+                    context &self,
+                    const context::operations::errlogfnc_t &fnc,
+                    uint64_t file_id,
+                    uint64_t base_line);
+
+            // Returns the CfgFunctions functions compiled into the global with the given name, ignoring case.
+            [[nodiscard]] static std::pair<success_t, std::vector<tables::t_config_function>> find_config_functions_by_name(
+                    context &self,
+                    const context::operations::errlogfnc_t &fnc,
+                    const std::string &name);
+
             [[nodiscard]] static std::pair<success_t, std::vector<tables::t_reference>> get_all_variables_of_variable(
                     context &self,
                     const context::operations::errlogfnc_t &fnc,
@@ -299,6 +423,22 @@ namespace sqfvm::language_server::database {
                     context &self,
                     const context::operations::errlogfnc_t &fnc,
                     uint64_t variable_id);
+
+            // Switches the database to incremental auto vacuum, returning whether this required a full VACUUM.
+            // The VACUUM rewrites the whole database, hence this is meant to run once at startup.
+            [[nodiscard]] static std::pair<success_t, bool> enable_incremental_vacuum(
+                    context &self,
+                    const context::operations::errlogfnc_t &fnc);
+
+            // Removes orphaned rows, releases a bounded amount of free pages and updates the query planner
+            // statistics. Must not run while an analyzer is committing.
+            [[nodiscard]] static std::pair<success_t, maintenance_result> run_maintenance(
+                    context &self,
+                    const context::operations::errlogfnc_t &fnc);
+
+            [[nodiscard]] static std::pair<success_t, database_statistics> get_statistics(
+                    context &self,
+                    const context::operations::errlogfnc_t &fnc);
         };
     };
 }
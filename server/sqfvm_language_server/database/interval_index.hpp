@@ -0,0 +1,95 @@
+#ifndef SQFVM_LANGUAGE_SERVER_DATABASE_INTERVAL_INDEX_HPP
+#define SQFVM_LANGUAGE_SERVER_DATABASE_INTERVAL_INDEX_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace sqfvm::language_server::database {
+    // Static index over closed intervals [start, end], answering which intervals contain a value or overlap a range.
+    // Intervals are kept sorted by start and, for equal starts, by end descending, making the last of
+    // all intervals containing a value the innermost one.
+    class interval_index {
+        std::vector<uint64_t> m_starts;
+        std::vector<uint64_t> m_ends;
+
+        // Segment tree holding the maximum end of every subtree, node 1 being the root and m_leaves
+        // the index of the first leaf. Allows to skip every subtree that ends before a value.
+        std::vector<uint64_t> m_max_ends;
+        size_t m_leaves = 0;
+
+        // Appends the indices of all intervals in the subtree of node that are below limit and end at or after key,
+        // in descending order. Stops after the first one if only_last is set.
+        void collect(
+                size_t node,
+                size_t node_begin,
+                size_t node_end,
+                size_t limit,
+                uint64_t key,
+                bool only_last,
+                std::vector<size_t> &out) const {
+            if (node_begin >= limit || m_max_ends[node] < key)
+                return;
+            if (node_end - node_begin == 1) {
+                out.push_back(node_begin);
+                return;
+            }
+            auto middle = node_begin + (node_end - node_begin) / 2;
+            collect(node * 2 + 1, middle, node_end, limit, key, only_last, out);
+            if (only_last && !out.empty())
+                return;
+            collect(node * 2, node_begin, middle, limit, key, only_last, out);
+        }
+
+    public:
+        // Whether interval l has to precede interval r when passed to build(...).
+        [[nodiscard]] static bool precedes(uint64_t l_start, uint64_t l_end, uint64_t r_start, uint64_t r_end) {
+            return l_start < r_start || (l_start == r_start && l_end > r_end);
+        }
+
+        // Replaces the indexed intervals. starts and ends have to be ordered as defined by precedes(...).
+        void build(std::vector<uint64_t> starts, std::vector<uint64_t> ends) {
+            m_starts = std::move(starts);
+            m_ends = std::move(ends);
+            m_leaves = 1;
+            while (m_leaves < m_ends.size())
+                m_leaves *= 2;
+            m_max_ends.assign(m_leaves * 2, 0);
+            std::copy(m_ends.begin(), m_ends.end(), m_max_ends.begin() + static_cast<ptrdiff_t>(m_leaves));
+            for (auto node = m_leaves - 1; node > 0; node--) {
+                m_max_ends[node] = std::max(m_max_ends[node * 2], m_max_ends[node * 2 + 1]);
+            }
+        }
+
+        [[nodiscard]] size_t size() const { return m_starts.size(); }
+
+        [[nodiscard]] uint64_t start(size_t index) const { return m_starts[index]; }
+
+        [[nodiscard]] uint64_t end(size_t index) const { return m_ends[index]; }
+
+        // Returns the index of the innermost interval containing value in O(log n).
+        [[nodiscard]] std::optional<size_t> innermost(uint64_t value) const {
+            std::vector<size_t> out;
+            auto limit = static_cast<size_t>(
+                    std::upper_bound(m_starts.begin(), m_starts.end(), value) - m_starts.begin());
+            if (limit > 0)
+                collect(1, 0, m_leaves, limit, value, true, out);
+            if (out.empty())
+                return std::nullopt;
+            return out.front();
+        }
+
+        // Returns the indices of all intervals overlapping [from, to], in reverse build order.
+        [[nodiscard]] std::vector<size_t> intersecting(uint64_t from, uint64_t to) const {
+            std::vector<size_t> out;
+            auto limit = static_cast<size_t>(
+                    std::upper_bound(m_starts.begin(), m_starts.end(), to) - m_starts.begin());
+            if (limit > 0)
+                collect(1, 0, m_leaves, limit, from, false, out);
+            return out;
+        }
+    };
+}
+
+#endif //SQFVM_LANGUAGE_SERVER_DATABASE_INTERVAL_INDEX_HPP
@@ -52,4 +52,5 @@ ORM_ENUM_MAPPING(sqfvm::language_server::database::tables::t_reference::type_fla
 ORM_ENUM_MAPPING(sqfvm::language_server::database::tables::t_reference::access_flags, int)
 ORM_ENUM_MAPPING(sqfvm::language_server::database::tables::t_code_action::action_kind, int)
 ORM_ENUM_MAPPING(sqfvm::language_server::database::tables::t_code_action_change::file_operation, int)
+ORM_ENUM_MAPPING(sqfvm::language_server::database::tables::t_folding_range::range_kind, int)
 #endif //SQFVM_LANGUAGE_SERVER_DATABASE_ORM_MAPPINGS_HPP
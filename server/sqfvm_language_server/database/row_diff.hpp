@@ -0,0 +1,467 @@
+#ifndef SQFVM_LANGUAGE_SERVER_DATABASE_ROW_DIFF_HPP
+#define SQFVM_LANGUAGE_SERVER_DATABASE_ROW_DIFF_HPP
+
+#include "context.hpp"
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace sqfvm::language_server::database {
+    // Amount of rows touched by apply_diff.
+    struct diff_result {
+        size_t inserted;
+        size_t updated;
+        size_t removed;
+        size_t unchanged;
+
+        diff_result &operator+=(const diff_result &other) {
+            inserted += other.inserted;
+            updated += other.updated;
+            removed += other.removed;
+            unchanged += other.unchanged;
+            return *this;
+        }
+    };
+
+    // SQLite limits the parameters bound by a single statement, to 999 by default before version 3.32. Lists of
+    // ids or rows are hence bound in chunks. Chunks of ids stay at max_bound_parameters, leaving room for the
+    // other parameters of a statement.
+    constexpr size_t sqlite_max_bound_parameters = 999;
+    constexpr size_t max_bound_parameters = 500;
+
+    // Calls fn with consecutive chunks of at most max_items of the given items, passing items itself if they
+    // fit into a single chunk.
+    template<typename T, typename TFunc>
+    void for_each_chunk(const std::vector<T> &items, size_t max_items, TFunc fn) {
+        if (items.size() <= max_items) {
+            if (!items.empty())
+                fn(items);
+            return;
+        }
+        for (size_t i = 0; i < items.size(); i += max_items) {
+            std::vector<T> chunk(
+                    items.begin() + static_cast<ptrdiff_t>(i),
+                    items.begin() + static_cast<ptrdiff_t>(std::min(i + max_items, items.size())));
+            fn(chunk);
+        }
+    }
+
+#pragma region Row keys and values
+    // diff_key identifies a row across two analysis results, diff_value holds the remaining columns
+    // (excluding id_pk) that are compared to decide whether a matched row has to be updated.
+    // Keys deliberately leave out positions, as an edit moves every row after it. Rows sharing a key
+    // are instead paired in the order given by diff_order, i.e. the n-th reference to a variable stays
+    // the n-th reference to it. Offsets are not compared either: they change with every edit before
+    // the row while nothing reads them back from the database, hence they are only written along
+    // with other changes.
+
+    inline auto diff_key(const tables::t_reference &row) {
+        return std::make_tuple(row.file_fk, row.variable_fk);
+    }
+
+    inline auto diff_order(const tables::t_reference &row) {
+        return std::make_tuple(row.line, row.column);
+    }
+
+    inline auto diff_value(const tables::t_reference &row) {
+        return std::make_tuple(
+                row.source_file_fk,
+                row.line,
+                row.column,
+                row.access,
+                row.length,
+                row.types,
+                row.is_declaration,
+                row.is_magic_variable);
+    }
+
+    inline auto diff_key(const tables::t_hover &row) {
+        return std::make_tuple(row.file_fk, row.content_fk);
+    }
+
+    inline auto diff_order(const tables::t_hover &row) {
+        return std::make_tuple(row.start_line, row.start_column, row.end_line, row.end_column);
+    }
+
+    inline auto diff_value(const tables::t_hover &row) {
+        return std::make_tuple(row.start_line, row.start_column, row.end_line, row.end_column);
+    }
+
+    inline auto diff_key(const tables::t_folding_range &row) {
+        return std::make_tuple(row.file_fk, row.kind);
+    }
+
+    inline auto diff_order(const tables::t_folding_range &row) {
+        return std::make_tuple(row.start_line, row.end_line);
+    }
+
+    inline auto diff_value(const tables::t_folding_range &row) {
+        return std::make_tuple(row.start_line, row.end_line);
+    }
+
+    inline auto diff_key(const tables::t_diagnostic &row) {
+        return std::tie(row.file_fk, row.code, row.content);
+    }
+
+    inline auto diff_order(const tables::t_diagnostic &row) {
+        return std::make_tuple(row.line, row.column);
+    }
+
+    inline auto diff_value(const tables::t_diagnostic &row) {
+        return std::tie(
+                row.source_file_fk,
+                row.line,
+                row.column,
+                row.length,
+                row.severity,
+                row.message,
+                row.is_suppressed);
+    }
+
+    inline auto diff_key(const tables::t_file_include &row) {
+        return std::make_tuple(row.file_included_fk, row.file_included_in_fk, row.source_file_fk);
+    }
+
+    inline auto diff_order(const tables::t_file_include &) {
+        return std::make_tuple();
+    }
+
+    inline auto diff_value(const tables::t_file_include &) {
+        return std::make_tuple();
+    }
+
+    inline auto diff_key(const tables::t_config_class &row) {
+        return std::tie(row.file_fk, row.path);
+    }
+
+    inline auto diff_order(const tables::t_config_class &row) {
+        return std::make_tuple(row.line, row.column);
+    }
+
+    inline auto diff_value(const tables::t_config_class &row) {
+        return std::tie(
+                row.source_file_fk,
+                row.name,
+                row.parent_path,
+                row.base_name,
+                row.opt_base_path,
+                row.line,
+                row.column,
+                row.base_line,
+                row.base_column);
+    }
+
+    inline auto diff_key(const tables::t_config_property &row) {
+        return std::tie(row.file_fk, row.class_path, row.name);
+    }
+
+    inline auto diff_order(const tables::t_config_property &row) {
+        return std::make_tuple(row.line, row.column);
+    }
+
+    inline auto diff_value(const tables::t_config_property &row) {
+        return std::tie(
+                row.source_file_fk,
+                row.value,
+                row.is_append,
+                row.line,
+                row.column);
+    }
+
+    inline auto diff_key(const tables::t_config_function &row) {
+        return std::tie(row.file_fk, row.name);
+    }
+
+    inline auto diff_order(const tables::t_config_function &row) {
+        return std::make_tuple(row.line, row.column);
+    }
+
+    inline auto diff_value(const tables::t_config_function &row) {
+        return std::tie(
+                row.source_file_fk,
+                row.path,
+                row.opt_target_file_fk,
+                row.line,
+                row.column);
+    }
+
+    inline auto diff_key(const tables::t_code_action &row) {
+        return std::tie(row.file_fk, row.kind, row.identifier, row.text);
+    }
+
+    inline auto diff_order(const tables::t_code_action &) {
+        return std::make_tuple();
+    }
+
+    inline auto diff_value(const tables::t_code_action &) {
+        return std::make_tuple();
+    }
+
+    inline auto diff_value(const tables::t_code_action_change &row) {
+        return std::tie(
+                row.operation,
+                row.old_path,
+                row.path,
+                row.start_line,
+                row.start_column,
+                row.end_line,
+                row.end_column,
+                row.content);
+    }
+#pragma endregion
+
+    // Removes all rows of T with the given primary keys.
+    template<typename T>
+    void remove_by_ids(context::storage_t &storage, const std::vector<uint64_t> &ids) {
+        using namespace sqlite_orm;
+        for_each_chunk(ids, max_bound_parameters, [&](const std::vector<uint64_t> &chunk) {
+            storage.remove_all<T>(where(in(&T::id_pk, chunk)));
+        });
+    }
+
+    // Rows bound by a single insert or replace, covering tables of up to 15 columns.
+    constexpr size_t max_rows_per_statement = sqlite_max_bound_parameters / 15;
+
+    // Inserts the given rows, using one statement per max_rows_per_statement rows.
+    template<typename T>
+    void insert_rows(context::storage_t &storage, const std::vector<T> &rows) {
+        for (size_t i = 0; i < rows.size(); i += max_rows_per_statement) {
+            storage.insert_range(
+                    rows.begin() + static_cast<ptrdiff_t>(i),
+                    rows.begin() + static_cast<ptrdiff_t>(std::min(i + max_rows_per_statement, rows.size())));
+        }
+    }
+
+    // Overwrites the stored rows with the same id_pk as the given rows, using one statement per
+    // max_rows_per_statement rows.
+    template<typename T>
+    void replace_rows(context::storage_t &storage, const std::vector<T> &rows) {
+        for (size_t i = 0; i < rows.size(); i += max_rows_per_statement) {
+            storage.replace_range(
+                    rows.begin() + static_cast<ptrdiff_t>(i),
+                    rows.begin() + static_cast<ptrdiff_t>(std::min(i + max_rows_per_statement, rows.size())));
+        }
+    }
+
+    // Writes the difference between old_rows (what currently is stored) and new_rows (what should be stored).
+    // Rows are matched via diff_key, rows sharing a key in the order of diff_order. Matched rows keep their
+    // id_pk and are only updated if their diff_value changed, unmatched old rows are removed and unmatched
+    // new rows are inserted. Updates and inserts are written in bulk.
+    // Afterwards, every row in new_rows carries its id_pk if assign_ids is true. Otherwise, the id_pk
+    // of inserted rows remains unset.
+    template<typename T>
+    diff_result apply_diff(
+            context::storage_t &storage,
+            const std::vector<T> &old_rows,
+            std::vector<T> &new_rows,
+            bool assign_ids = false) {
+        diff_result result{};
+        auto sorted_indices = [](const std::vector<T> &rows) {
+            std::vector<size_t> indices(rows.size());
+            std::iota(indices.begin(), indices.end(), 0);
+            std::sort(indices.begin(), indices.end(), [&](size_t l, size_t r) {
+                auto l_key = diff_key(rows[l]);
+                auto r_key = diff_key(rows[r]);
+                if (l_key != r_key)
+                    return l_key < r_key;
+                return diff_order(rows[l]) < diff_order(rows[r]);
+            });
+            return indices;
+        };
+        auto old_order = sorted_indices(old_rows);
+        auto new_order = sorted_indices(new_rows);
+
+        // Both sides are walked in key order, pairing rows of equal keys one by one
+        std::vector<T> inserts;
+        std::vector<T> updates;
+        std::vector<uint64_t> removes;
+        size_t old_index = 0;
+        size_t new_index = 0;
+        while (old_index < old_order.size() || new_index < new_order.size()) {
+            if (new_index == new_order.size()
+                || (old_index < old_order.size()
+                    && diff_key(old_rows[old_order[old_index]]) < diff_key(new_rows[new_order[new_index]]))) {
+                removes.push_back(old_rows[old_order[old_index++]].id_pk);
+                continue;
+            }
+            auto &row = new_rows[new_order[new_index++]];
+            if (old_index == old_order.size() || diff_key(row) < diff_key(old_rows[old_order[old_index]])) {
+                row.id_pk = 0;
+                if (assign_ids) {
+                    row.id_pk = storage.insert(row);
+                } else {
+                    inserts.push_back(row);
+                }
+                result.inserted++;
+                continue;
+            }
+            const auto &old_row = old_rows[old_order[old_index++]];
+            row.id_pk = old_row.id_pk;
+            if (diff_value(old_row) == diff_value(row)) {
+                result.unchanged++;
+            } else {
+                updates.push_back(row);
+                result.updated++;
+            }
+        }
+
+        remove_by_ids<T>(storage, removes);
+        result.removed = removes.size();
+        replace_rows(storage, updates);
+        insert_rows(storage, inserts);
+        return result;
+    }
+
+    // 64-bit FNV-1a hash of the given content. Unlike std::hash, the result is stable across
+    // processes and platforms, allowing it to be persisted.
+    inline int64_t content_hash(std::string_view content) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (auto c: content) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001b3ULL;
+        }
+        return static_cast<int64_t>(hash);
+    }
+
+    // Returns the t_hover_content id for each of the given markdowns, inserting the ones not yet stored.
+    inline std::vector<uint64_t> intern_hover_contents(
+            context::storage_t &storage,
+            const std::vector<std::string> &markdowns) {
+        using namespace sqlite_orm;
+        using tables::t_hover_content;
+        std::vector<int64_t> hashes;
+        hashes.reserve(markdowns.size());
+        for (const auto &markdown: markdowns) {
+            hashes.push_back(content_hash(markdown));
+        }
+        std::vector<int64_t> unique_hashes(hashes.begin(), hashes.end());
+        std::sort(unique_hashes.begin(), unique_hashes.end());
+        unique_hashes.erase(std::unique(unique_hashes.begin(), unique_hashes.end()), unique_hashes.end());
+
+        std::unordered_map<int64_t, std::vector<t_hover_content>> known;
+        for_each_chunk(unique_hashes, max_bound_parameters, [&](const std::vector<int64_t> &chunk) {
+            for (auto &it: storage.get_all<t_hover_content>(where(in(&t_hover_content::hash, chunk)))) {
+                auto hash = it.hash;
+                known[hash].push_back(std::move(it));
+            }
+        });
+
+        std::vector<uint64_t> ids;
+        ids.reserve(markdowns.size());
+        for (size_t i = 0; i < markdowns.size(); i++) {
+            auto &candidates = known[hashes[i]];
+            auto found = std::find_if(candidates.begin(), candidates.end(), [&](const t_hover_content &it) {
+                return it.markdown == markdowns[i];
+            });
+            if (found != candidates.end()) {
+                ids.push_back(found->id_pk);
+                continue;
+            }
+            t_hover_content content{.id_pk = 0, .hash = hashes[i], .markdown = markdowns[i]};
+            content.id_pk = storage.insert(content);
+            ids.push_back(content.id_pk);
+            candidates.push_back(std::move(content));
+        }
+        return ids;
+    }
+
+    // Removes all of the given t_hover_content's which are no longer referred to by any t_hover.
+    inline void remove_unreferenced_hover_contents(
+            context::storage_t &storage,
+            const std::unordered_set<uint64_t> &content_ids) {
+        using namespace sqlite_orm;
+        std::vector<uint64_t> ids(content_ids.begin(), content_ids.end());
+        for_each_chunk(ids, max_bound_parameters, [&](const std::vector<uint64_t> &chunk) {
+            storage.remove_all<tables::t_hover_content>(
+                    where(in(&tables::t_hover_content::id_pk, chunk)
+                          and not_in(&tables::t_hover_content::id_pk, select(&tables::t_hover::content_fk))));
+        });
+    }
+
+    // Writes the difference between the code actions of the given file currently stored and new_actions.
+    // Code actions are matched via diff_key; the changes of a matched action are rewritten only if any differs.
+    inline diff_result apply_code_action_diff(
+            context::storage_t &storage,
+            uint64_t file_id,
+            std::vector<std::pair<tables::t_code_action, std::vector<tables::t_code_action_change>>> &new_actions) {
+        using namespace sqlite_orm;
+        using tables::t_code_action;
+        using tables::t_code_action_change;
+        auto old_actions = storage.get_all<t_code_action>(where(c(&t_code_action::file_fk) == file_id));
+        auto old_changes = storage.get_all<t_code_action_change>(
+                where(in(&t_code_action_change::code_action_fk,
+                         select(&t_code_action::id_pk, where(c(&t_code_action::file_fk) == file_id)))));
+        std::map<uint64_t, std::vector<t_code_action_change>> old_changes_by_action;
+        for (auto &change: old_changes) {
+            old_changes_by_action[change.code_action_fk].push_back(std::move(change));
+        }
+
+        // Changes of removed actions have to go first due to the foreign key
+        std::map<decltype(diff_key(std::declval<const t_code_action &>())), std::vector<size_t>> old_by_key;
+        for (size_t i = 0; i < old_actions.size(); i++) {
+            old_by_key[diff_key(old_actions[i])].push_back(i);
+        }
+        std::unordered_set<uint64_t> kept_action_ids;
+        for (auto &[action, _]: new_actions) {
+            auto it = old_by_key.find(diff_key(action));
+            if (it == old_by_key.end() || it->second.empty())
+                continue;
+            kept_action_ids.insert(old_actions[it->second.back()].id_pk);
+            it->second.pop_back();
+        }
+        std::vector<uint64_t> removed_change_ids;
+        for (auto &[action_id, changes]: old_changes_by_action) {
+            if (kept_action_ids.contains(action_id))
+                continue;
+            for (auto &change: changes) {
+                removed_change_ids.push_back(change.id_pk);
+            }
+        }
+        remove_by_ids<t_code_action_change>(storage, removed_change_ids);
+
+        std::vector<t_code_action> actions;
+        actions.reserve(new_actions.size());
+        for (auto &[action, _]: new_actions) {
+            actions.push_back(action);
+        }
+        auto result = apply_diff(storage, old_actions, actions, true);
+        result.removed += removed_change_ids.size();
+
+        for (size_t i = 0; i < actions.size(); i++) {
+            auto action_id = actions[i].id_pk;
+            auto &changes = new_actions[i].second;
+            for (auto &change: changes) {
+                change.code_action_fk = action_id;
+            }
+            auto old_it = old_changes_by_action.find(action_id);
+            if (old_it != old_changes_by_action.end()) {
+                auto &old = old_it->second;
+                if (std::equal(old.begin(), old.end(), changes.begin(), changes.end(), [](auto &l, auto &r) {
+                    return diff_value(l) == diff_value(r);
+                })) {
+                    result.unchanged += changes.size();
+                    continue;
+                }
+                std::vector<uint64_t> ids;
+                for (auto &change: old) {
+                    ids.push_back(change.id_pk);
+                }
+                remove_by_ids<t_code_action_change>(storage, ids);
+                result.removed += ids.size();
+            }
+            insert_rows(storage, changes);
+            result.inserted += changes.size();
+        }
+        return result;
+    }
+}
+
+#endif //SQFVM_LANGUAGE_SERVER_DATABASE_ROW_DIFF_HPP
@@ -0,0 +1,1009 @@
+#include "symbol_index.hpp"
+#include "row_diff.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+
+using namespace sqlite_orm;
+using namespace ::sqfvm::language_server::database::tables;
+
+namespace {
+    // Loads the code actions of the given file, or of all files if file_id is empty, together with their changes.
+    // Changes are fetched via a single query instead of one per code action.
+    std::unordered_map<uint64_t, std::vector<sqfvm::language_server::database::symbol_index::code_action_result>>
+    load_code_actions(sqfvm::language_server::database::context::storage_t &storage, std::optional<uint64_t> file_id) {
+        std::unordered_map<uint64_t, std::vector<sqfvm::language_server::database::symbol_index::code_action_result>> result;
+        auto code_actions = file_id.has_value()
+                            ? storage.get_all<t_code_action>(where(c(&t_code_action::file_fk) == *file_id))
+                            : storage.get_all<t_code_action>();
+        if (code_actions.empty())
+            return result;
+        auto changes = file_id.has_value()
+                       ? storage.get_all<t_code_action_change>(
+                        where(in(&t_code_action_change::code_action_fk,
+                                 select(&t_code_action::id_pk, where(c(&t_code_action::file_fk) == *file_id)))),
+                        order_by(&t_code_action_change::id_pk))
+                       : storage.get_all<t_code_action_change>(order_by(&t_code_action_change::id_pk));
+        std::unordered_map<uint64_t, std::vector<t_code_action_change>> changes_by_action;
+        for (auto &change: changes) {
+            changes_by_action[change.code_action_fk].push_back(std::move(change));
+        }
+        for (auto &code_action: code_actions) {
+            auto action_file_id = code_action.file_fk;
+            auto action_changes = std::move(changes_by_action[code_action.id_pk]);
+            result[action_file_id].push_back({std::move(code_action), std::move(action_changes)});
+        }
+        return result;
+    }
+
+    template<typename T, typename TKey>
+    std::vector<size_t> sorted_indices(const std::vector<T> &rows, TKey key) {
+        std::vector<size_t> indices(rows.size());
+        std::iota(indices.begin(), indices.end(), 0);
+        std::stable_sort(indices.begin(), indices.end(), [&](size_t l, size_t r) {
+            return key(rows[l]) < key(rows[r]);
+        });
+        return indices;
+    }
+}
+
+t_reference sqfvm::language_server::database::symbol_index::file_entry::reference_at(
+        size_t index,
+        uint64_t file_id) const {
+    return t_reference{
+            .id_pk = reference_id[index],
+            .file_fk = file_id,
+            .source_file_fk = reference_source_file[index],
+            .variable_fk = reference_variable[index],
+            .access = reference_access[index],
+            .line = reference_line[index],
+            .column = reference_column[index],
+            .offset = reference_offset[index],
+            .length = reference_length[index],
+            .types = reference_types[index],
+            .is_declaration = reference_is_declaration[index],
+            .is_magic_variable = reference_is_magic_variable[index],
+    };
+}
+
+t_hover sqfvm::language_server::database::symbol_index::file_entry::hover_at(
+        size_t index,
+        uint64_t file_id) const {
+    return t_hover{
+            .id_pk = hover_id[index],
+            .file_fk = file_id,
+            .start_line = hover_ranges.start(index) >> 32,
+            .start_column = hover_ranges.start(index) & 0xFFFFFFFF,
+            .end_line = hover_ranges.end(index) >> 32,
+            .end_column = hover_ranges.end(index) & 0xFFFFFFFF,
+            .content_fk = hover_content[index],
+    };
+}
+
+std::string sqfvm::language_server::database::symbol_index::fold_case(std::string_view name) {
+    std::string result(name);
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return result;
+}
+
+void sqfvm::language_server::database::symbol_index::unlink(
+        uint64_t file_id,
+        std::vector<uint64_t> &released_contents) {
+    auto file_it = m_files.find(file_id);
+    if (file_it == m_files.end())
+        return;
+    for (auto content_id: file_it->second.hover_content) {
+        auto content_it = m_hover_contents.find(content_id);
+        if (content_it != m_hover_contents.end() && --content_it->second.references == 0)
+            released_contents.push_back(content_id);
+    }
+    for (auto source_file_id: file_it->second.source_files) {
+        auto derived_it = m_derived_files.find(source_file_id);
+        if (derived_it == m_derived_files.end())
+            continue;
+        derived_it->second.erase(file_id);
+        if (derived_it->second.empty())
+            m_derived_files.erase(derived_it);
+    }
+    const auto &entry = file_it->second;
+    for (size_t i = 0; i < entry.reference_variable.size(); i++) {
+        if (!entry.reference_is_declaration[i])
+            continue;
+        auto declaration_it = m_declaration_files.find(entry.reference_variable[i]);
+        if (declaration_it == m_declaration_files.end())
+            continue;
+        declaration_it->second.erase(file_id);
+        if (declaration_it->second.empty())
+            m_declaration_files.erase(declaration_it);
+    }
+    for (auto variable_id: file_it->second.reference_variable) {
+        auto variable_it = m_variable_files.find(variable_id);
+        if (variable_it == m_variable_files.end())
+            continue;
+        variable_it->second.erase(file_id);
+        if (variable_it->second.empty()) {
+            m_variable_files.erase(variable_it);
+            auto known_it = m_variables.find(variable_id);
+            if (known_it == m_variables.end())
+                continue;
+            if (!known_it->second.opt_scope_fk.has_value()) {
+                m_global_trigrams.erase(variable_id);
+                auto name_it = m_global_names.find(fold_case(known_it->second.variable_name));
+                if (name_it != m_global_names.end()) {
+                    name_it->second.erase(variable_id);
+                    if (name_it->second.empty())
+                        m_global_names.erase(name_it);
+                }
+            }
+            m_variables.erase(known_it);
+        }
+    }
+    m_files.erase(file_it);
+}
+
+void sqfvm::language_server::database::symbol_index::link(uint64_t file_id) {
+    auto file_it = m_files.find(file_id);
+    if (file_it == m_files.end())
+        return;
+    for (auto source_file_id: file_it->second.source_files) {
+        m_derived_files[source_file_id].insert(file_id);
+    }
+    const auto &entry = file_it->second;
+    for (size_t i = 0; i < entry.reference_variable.size(); i++) {
+        m_variable_files[entry.reference_variable[i]].insert(file_id);
+        if (entry.reference_is_declaration[i])
+            m_declaration_files[entry.reference_variable[i]].insert(file_id);
+    }
+}
+
+void sqfvm::language_server::database::symbol_index::release_hover_contents(const std::vector<uint64_t> &content_ids) {
+    for (auto content_id: content_ids) {
+        auto content_it = m_hover_contents.find(content_id);
+        if (content_it != m_hover_contents.end() && content_it->second.references == 0)
+            m_hover_contents.erase(content_it);
+    }
+}
+
+void sqfvm::language_server::database::symbol_index::fill(
+        uint64_t file_id,
+        std::vector<tables::t_reference> references,
+        std::vector<tables::t_hover> hovers,
+        std::vector<tables::t_diagnostic> diagnostics,
+        std::vector<code_action_result> code_actions,
+        std::vector<tables::t_folding_range> folding_ranges) {
+    if (references.empty() && hovers.empty() && diagnostics.empty() && code_actions.empty() && folding_ranges.empty())
+        return;
+    auto &entry = m_files[file_id];
+
+    auto reference_order = sorted_indices(references, [](const t_reference &it) {
+        return std::make_pair(it.line, it.column);
+    });
+    entry.reference_id.reserve(references.size());
+    entry.reference_source_file.reserve(references.size());
+    entry.reference_variable.reserve(references.size());
+    entry.reference_line.reserve(references.size());
+    entry.reference_column.reserve(references.size());
+    entry.reference_offset.reserve(references.size());
+    entry.reference_length.reserve(references.size());
+    entry.reference_access.reserve(references.size());
+    entry.reference_types.reserve(references.size());
+    entry.reference_is_declaration.reserve(references.size());
+    entry.reference_is_magic_variable.reserve(references.size());
+    for (auto index: reference_order) {
+        const auto &reference = references[index];
+        entry.reference_id.push_back(reference.id_pk);
+        entry.reference_source_file.push_back(reference.source_file_fk);
+        entry.reference_variable.push_back(reference.variable_fk);
+        entry.reference_line.push_back(reference.line);
+        entry.reference_column.push_back(reference.column);
+        entry.reference_offset.push_back(reference.offset);
+        entry.reference_length.push_back(reference.length);
+        entry.reference_access.push_back(reference.access);
+        entry.reference_types.push_back(reference.types);
+        entry.reference_is_declaration.push_back(reference.is_declaration);
+        entry.reference_is_magic_variable.push_back(reference.is_magic_variable);
+        entry.source_files.insert(reference.source_file_fk);
+    }
+
+    auto hover_order = sorted_indices(hovers, [](const t_hover &it) {
+        return std::make_pair(
+                position_key(it.start_line, it.start_column),
+                ~position_key(it.end_line, it.end_column));
+    });
+    std::vector<uint64_t> hover_starts;
+    std::vector<uint64_t> hover_ends;
+    hover_starts.reserve(hovers.size());
+    hover_ends.reserve(hovers.size());
+    entry.hover_id.reserve(hovers.size());
+    entry.hover_content.reserve(hovers.size());
+    for (auto index: hover_order) {
+        const auto &hover = hovers[index];
+        entry.hover_id.push_back(hover.id_pk);
+        entry.hover_content.push_back(hover.content_fk);
+        auto content_it = m_hover_contents.find(hover.content_fk);
+        if (content_it != m_hover_contents.end())
+            content_it->second.references++;
+        hover_starts.push_back(position_key(hover.start_line, hover.start_column));
+        hover_ends.push_back(position_key(hover.end_line, hover.end_column));
+    }
+    entry.hover_ranges.build(std::move(hover_starts), std::move(hover_ends));
+
+    std::sort(code_actions.begin(), code_actions.end(), [](const auto &l, const auto &r) {
+        return l.code_action.id_pk < r.code_action.id_pk;
+    });
+    struct change_range {
+        uint64_t start;
+        uint64_t end;
+        size_t owner;
+    };
+    std::vector<change_range> change_ranges;
+    for (auto &[code_action, changes]: code_actions) {
+        for (const auto &change: changes) {
+            if (!change.start_line.has_value() || !change.start_column.has_value()
+                || !change.end_line.has_value() || !change.end_column.has_value())
+                continue;
+            change_ranges.push_back({
+                    .start = position_key(*change.start_line, *change.start_column),
+                    .end = position_key(*change.end_line, *change.end_column),
+                    .owner = entry.code_actions.size(),
+            });
+        }
+        entry.code_actions.push_back(std::move(code_action));
+        entry.code_action_changes.push_back(std::move(changes));
+    }
+    std::sort(change_ranges.begin(), change_ranges.end(), [](const auto &l, const auto &r) {
+        return interval_index::precedes(l.start, l.end, r.start, r.end);
+    });
+    std::vector<uint64_t> change_starts;
+    std::vector<uint64_t> change_ends;
+    for (const auto &it: change_ranges) {
+        change_starts.push_back(it.start);
+        change_ends.push_back(it.end);
+        entry.code_action_range_owner.push_back(it.owner);
+    }
+    entry.code_action_ranges.build(std::move(change_starts), std::move(change_ends));
+
+    auto folding_order = sorted_indices(folding_ranges, [](const t_folding_range &it) {
+        return std::make_pair(it.start_line, it.end_line);
+    });
+    entry.folding_start_line.reserve(folding_ranges.size());
+    entry.folding_end_line.reserve(folding_ranges.size());
+    entry.folding_kind.reserve(folding_ranges.size());
+    for (auto index: folding_order) {
+        const auto &folding_range = folding_ranges[index];
+        entry.folding_start_line.push_back(folding_range.start_line);
+        entry.folding_end_line.push_back(folding_range.end_line);
+        entry.folding_kind.push_back(folding_range.kind);
+    }
+
+    for (const auto &diagnostic: diagnostics) {
+        entry.source_files.insert(diagnostic.source_file_fk);
+    }
+    entry.diagnostics = std::move(diagnostics);
+    link(file_id);
+}
+
+std::vector<t_variable> sqfvm::language_server::database::symbol_index::query_variables(
+        context &ctx,
+        const std::unordered_set<uint64_t> &variable_ids) {
+    std::vector<uint64_t> ids(variable_ids.begin(), variable_ids.end());
+    std::vector<t_variable> variables;
+    for_each_chunk(ids, max_bound_parameters, [&](const std::vector<uint64_t> &chunk) {
+        auto result = ctx.storage().get_all<t_variable>(where(in(&t_variable::id_pk, chunk)));
+        variables.insert(variables.end(),
+                         std::make_move_iterator(result.begin()),
+                         std::make_move_iterator(result.end()));
+    });
+    return variables;
+}
+
+void sqfvm::language_server::database::symbol_index::store_variables(std::vector<tables::t_variable> variables) {
+    for (auto &variable: variables) {
+        if (!m_variable_files.contains(variable.id_pk))
+            continue;
+        auto id = variable.id_pk;
+        if (!variable.opt_scope_fk.has_value()) {
+            auto folded_name = fold_case(variable.variable_name);
+            m_global_names[folded_name].insert(id);
+            m_global_trigrams.insert(id, std::move(folded_name));
+        }
+        m_variables[id] = std::move(variable);
+    }
+}
+
+void sqfvm::language_server::database::symbol_index::encode_semantic_tokens(file_entry &entry) const {
+    entry.semantic_tokens.clear();
+    entry.semantic_tokens.reserve(entry.reference_id.size() * 5);
+    // Privates only ever are declared in the file they belong to
+    std::unordered_set<uint64_t> declared;
+    for (size_t i = 0; i < entry.reference_variable.size(); i++) {
+        if (entry.reference_is_declaration[i])
+            declared.insert(entry.reference_variable[i]);
+    }
+    uint64_t previous_line = 0;
+    uint64_t previous_column = 0;
+    for (size_t i = 0; i < entry.reference_variable.size(); i++) {
+        // Tokens may neither overlap nor appear twice, references are sorted by position
+        if (entry.reference_line[i] == 0 || (i > 0
+                                             && entry.reference_line[i] == entry.reference_line[i - 1]
+                                             && entry.reference_column[i] == entry.reference_column[i - 1]))
+            continue;
+        auto variable_it = m_variables.find(entry.reference_variable[i]);
+        if (variable_it == m_variables.end())
+            continue;
+        const auto &variable = variable_it->second;
+        auto is_private = variable.opt_scope_fk.has_value();
+        auto type = (entry.reference_types[i] & t_reference::type_flags::code) == t_reference::type_flags::code
+                    ? semantic_token_type::function
+                    : semantic_token_type::variable;
+        uint32_t modifiers = is_private ? private_variable : global_variable;
+        if (entry.reference_is_declaration[i])
+            modifiers |= declaration;
+        if (entry.reference_is_magic_variable[i])
+            modifiers |= magic_variable;
+        else if (is_private && !declared.contains(variable.id_pk))
+            modifiers |= undefined_variable;
+
+        auto line = entry.reference_line[i] - 1;
+        auto column = entry.reference_column[i];
+        entry.semantic_tokens.push_back(static_cast<uint32_t>(line - previous_line));
+        entry.semantic_tokens.push_back(static_cast<uint32_t>(line == previous_line ? column - previous_column : column));
+        entry.semantic_tokens.push_back(static_cast<uint32_t>(entry.reference_length[i]));
+        entry.semantic_tokens.push_back(static_cast<uint32_t>(type));
+        entry.semantic_tokens.push_back(modifiers);
+        previous_line = line;
+        previous_column = column;
+    }
+}
+
+void sqfvm::language_server::database::symbol_index::load_hover_contents(
+        context &ctx,
+        const std::unordered_set<uint64_t> &content_ids) {
+    std::vector<uint64_t> ids;
+    {
+        std::shared_lock lock(m_mutex);
+        for (auto id: content_ids) {
+            if (!m_hover_contents.contains(id))
+                ids.push_back(id);
+        }
+    }
+    std::vector<t_hover_content> contents;
+    for_each_chunk(ids, max_bound_parameters, [&](const std::vector<uint64_t> &chunk) {
+        auto result = ctx.storage().get_all<t_hover_content>(where(in(&t_hover_content::id_pk, chunk)));
+        contents.insert(contents.end(),
+                        std::make_move_iterator(result.begin()),
+                        std::make_move_iterator(result.end()));
+    });
+    std::unique_lock lock(m_mutex);
+    for (auto &content: contents) {
+        m_hover_contents.try_emplace(content.id_pk, hover_content_entry{.markdown = std::move(content.markdown)});
+    }
+}
+
+std::vector<std::pair<uint64_t, std::string>> sqfvm::language_server::database::symbol_index::query_file_paths(
+        context &ctx,
+        const std::unordered_set<uint64_t> &file_ids) {
+    std::vector<uint64_t> ids(file_ids.begin(), file_ids.end());
+    std::vector<std::pair<uint64_t, std::string>> paths;
+    for_each_chunk(ids, max_bound_parameters, [&](const std::vector<uint64_t> &chunk) {
+        for (auto &[id, path]: ctx.storage().select(
+                columns(&t_file::id_pk, &t_file::path),
+                where(in(&t_file::id_pk, chunk)))) {
+            paths.emplace_back(id, std::move(path));
+        }
+    });
+    return paths;
+}
+
+void sqfvm::language_server::database::symbol_index::store_file_paths(
+        const std::unordered_set<uint64_t> &file_ids,
+        std::vector<std::pair<uint64_t, std::string>> paths) {
+    for (auto id: file_ids) {
+        m_file_paths.erase(id);
+    }
+    for (auto &[id, path]: paths) {
+        m_file_paths[id] = std::move(path);
+    }
+}
+
+void sqfvm::language_server::database::symbol_index::set_functions(
+        uint64_t source_file_id,
+        std::vector<tables::t_config_function> functions) {
+    auto source_it = m_source_functions.find(source_file_id);
+    if (source_it != m_source_functions.end()) {
+        for (auto function_id: source_it->second) {
+            m_functions.erase(function_id);
+            m_function_trigrams.erase(function_id);
+        }
+        m_source_functions.erase(source_it);
+    }
+    if (functions.empty())
+        return;
+    auto &function_ids = m_source_functions[source_file_id];
+    for (auto &function: functions) {
+        function_ids.insert(function.id_pk);
+        m_function_trigrams.insert(function.id_pk, fold_case(function.name));
+        m_functions.insert_or_assign(function.id_pk, std::move(function));
+    }
+}
+
+void sqfvm::language_server::database::symbol_index::load(context &ctx) {
+    auto &storage = ctx.storage();
+    std::unordered_map<uint64_t, std::vector<t_reference>> references;
+    std::unordered_map<uint64_t, std::vector<t_hover>> hovers;
+    std::unordered_map<uint64_t, std::vector<t_diagnostic>> diagnostics;
+    std::unordered_set<uint64_t> file_ids;
+    std::unordered_set<uint64_t> variable_ids;
+    for (auto &it: storage.get_all<t_reference>()) {
+        file_ids.insert(it.file_fk);
+        variable_ids.insert(it.variable_fk);
+        references[it.file_fk].push_back(std::move(it));
+    }
+    for (auto &it: storage.get_all<t_hover>()) {
+        file_ids.insert(it.file_fk);
+        hovers[it.file_fk].push_back(std::move(it));
+    }
+    for (auto &it: storage.get_all<t_diagnostic>()) {
+        file_ids.insert(it.file_fk);
+        diagnostics[it.file_fk].push_back(std::move(it));
+    }
+    auto code_actions = load_code_actions(storage, std::nullopt);
+    for (const auto &[file_id, _]: code_actions) {
+        file_ids.insert(file_id);
+    }
+    std::unordered_map<uint64_t, std::vector<t_folding_range>> folding_ranges;
+    for (auto &it: storage.get_all<t_folding_range>()) {
+        file_ids.insert(it.file_fk);
+        folding_ranges[it.file_fk].push_back(std::move(it));
+    }
+    std::unordered_map<uint64_t, std::vector<t_config_function>> functions;
+    for (auto &it: storage.get_all<t_config_function>()) {
+        functions[it.source_file_fk].push_back(std::move(it));
+    }
+    auto hover_contents = storage.get_all<t_hover_content>();
+    auto variables = query_variables(ctx, variable_ids);
+    auto paths = query_file_paths(ctx, file_ids);
+    std::unique_lock lock(m_mutex);
+    m_files.clear();
+    m_variables.clear();
+    m_hover_contents.clear();
+    m_file_paths.clear();
+    m_derived_files.clear();
+    m_variable_files.clear();
+    m_global_names.clear();
+    m_global_trigrams.clear();
+    m_declaration_files.clear();
+    m_functions.clear();
+    m_source_functions.clear();
+    m_function_trigrams.clear();
+    for (auto &[source_file_id, source_functions]: functions) {
+        set_functions(source_file_id, std::move(source_functions));
+    }
+    for (auto &content: hover_contents) {
+        m_hover_contents.emplace(content.id_pk, hover_content_entry{.markdown = std::move(content.markdown)});
+    }
+    for (auto file_id: file_ids) {
+        fill(file_id,
+             std::move(references[file_id]),
+             std::move(hovers[file_id]),
+             std::move(diagnostics[file_id]),
+             std::move(code_actions[file_id]),
+             std::move(folding_ranges[file_id]));
+    }
+    // Contents no hover refers to are left over by earlier commits
+    std::erase_if(m_hover_contents, [](const auto &it) { return it.second.references == 0; });
+    store_variables(std::move(variables));
+    store_file_paths(file_ids, std::move(paths));
+    m_generation++;
+    for (auto &[_, entry]: m_files) {
+        encode_semantic_tokens(entry);
+        entry.generation = m_generation;
+    }
+    m_loaded = true;
+}
+
+std::vector<uint64_t> sqfvm::language_server::database::symbol_index::refresh(
+        context &ctx,
+        uint64_t source_file_id) {
+    auto &storage = ctx.storage();
+    std::unordered_set<uint64_t> file_ids{source_file_id};
+    {
+        std::shared_lock lock(m_mutex);
+        auto derived_it = m_derived_files.find(source_file_id);
+        if (derived_it != m_derived_files.end())
+            file_ids.insert(derived_it->second.begin(), derived_it->second.end());
+    }
+    for (auto file_id: storage.select(
+            distinct(&t_reference::file_fk),
+            where(c(&t_reference::source_file_fk) == source_file_id))) {
+        file_ids.insert(file_id);
+    }
+    for (auto file_id: storage.select(
+            distinct(&t_diagnostic::file_fk),
+            where(c(&t_diagnostic::source_file_fk) == source_file_id))) {
+        file_ids.insert(file_id);
+    }
+
+    std::unordered_map<uint64_t, std::vector<t_reference>> references;
+    std::unordered_map<uint64_t, std::vector<t_hover>> hovers;
+    std::unordered_map<uint64_t, std::vector<t_diagnostic>> diagnostics;
+    std::unordered_map<uint64_t, std::vector<code_action_result>> code_actions;
+    std::unordered_map<uint64_t, std::vector<t_folding_range>> folding_ranges;
+    std::unordered_set<uint64_t> variable_ids;
+    std::unordered_set<uint64_t> content_ids;
+    for (auto file_id: file_ids) {
+        code_actions[file_id] = std::move(load_code_actions(storage, file_id)[file_id]);
+        references[file_id] = storage.get_all<t_reference>(where(c(&t_reference::file_fk) == file_id));
+        hovers[file_id] = storage.get_all<t_hover>(where(c(&t_hover::file_fk) == file_id));
+        diagnostics[file_id] = storage.get_all<t_diagnostic>(where(c(&t_diagnostic::file_fk) == file_id));
+        folding_ranges[file_id] = storage.get_all<t_folding_range>(where(c(&t_folding_range::file_fk) == file_id));
+        for (const auto &it: references[file_id]) {
+            variable_ids.insert(it.variable_fk);
+        }
+        for (const auto &it: hovers[file_id]) {
+            content_ids.insert(it.content_fk);
+        }
+    }
+    load_hover_contents(ctx, content_ids);
+    auto functions = storage.get_all<t_config_function>(
+            where(c(&t_config_function::source_file_fk) == source_file_id));
+    auto variables = query_variables(ctx, variable_ids);
+    auto paths = query_file_paths(ctx, file_ids);
+
+    // Swapped in under a single lock, so that no reader sees references whose variables are not loaded yet
+    std::unique_lock lock(m_mutex);
+    set_functions(source_file_id, std::move(functions));
+    std::vector<uint64_t> released_contents;
+    for (auto file_id: file_ids) {
+        unlink(file_id, released_contents);
+    }
+    for (auto file_id: file_ids) {
+        fill(file_id,
+             std::move(references[file_id]),
+             std::move(hovers[file_id]),
+             std::move(diagnostics[file_id]),
+             std::move(code_actions[file_id]),
+             std::move(folding_ranges[file_id]));
+    }
+    release_hover_contents(released_contents);
+    store_variables(std::move(variables));
+    store_file_paths(file_ids, std::move(paths));
+    m_generation++;
+    for (auto file_id: file_ids) {
+        auto file_it = m_files.find(file_id);
+        if (file_it == m_files.end())
+            continue;
+        encode_semantic_tokens(file_it->second);
+        file_it->second.generation = m_generation;
+    }
+    return {file_ids.begin(), file_ids.end()};
+}
+
+std::vector<uint64_t> sqfvm::language_server::database::symbol_index::file_ids() const {
+    std::shared_lock lock(m_mutex);
+    std::vector<uint64_t> result;
+    result.reserve(m_files.size());
+    for (const auto &[file_id, _]: m_files) {
+        result.push_back(file_id);
+    }
+    return result;
+}
+
+std::vector<tables::t_reference> sqfvm::language_server::database::symbol_index::references_at_line(
+        uint64_t file_id,
+        uint64_t line,
+        bool exclude_magical) const {
+    std::shared_lock lock(m_mutex);
+    std::vector<t_reference> result;
+    auto file_it = m_files.find(file_id);
+    if (file_it == m_files.end())
+        return result;
+    const auto &entry = file_it->second;
+    auto [begin, end] = std::equal_range(entry.reference_line.begin(), entry.reference_line.end(), line);
+    for (auto it = begin; it != end; ++it) {
+        auto index = static_cast<size_t>(it - entry.reference_line.begin());
+        if (exclude_magical && entry.reference_is_magic_variable[index])
+            continue;
+        result.push_back(entry.reference_at(index, file_id));
+    }
+    return result;
+}
+
+std::optional<tables::t_reference> sqfvm::language_server::database::symbol_index::reference_at(
+        uint64_t file_id,
+        uint64_t line,
+        uint64_t column,
+        bool exclude_magical) const {
+    std::shared_lock lock(m_mutex);
+    auto file_it = m_files.find(file_id);
+    if (file_it == m_files.end())
+        return std::nullopt;
+    const auto &entry = file_it->second;
+    auto [line_begin, line_end] = std::equal_range(entry.reference_line.begin(), entry.reference_line.end(), line);
+    auto first = static_cast<size_t>(line_begin - entry.reference_line.begin());
+    auto last = static_cast<size_t>(line_end - entry.reference_line.begin());
+
+    // Columns are sorted within a line, hence walk back from the last reference starting before the position
+    auto start = std::lower_bound(
+            entry.reference_column.begin() + static_cast<ptrdiff_t>(first),
+            entry.reference_column.begin() + static_cast<ptrdiff_t>(last),
+            column);
+    for (auto index = static_cast<size_t>(start - entry.reference_column.begin()); index > first; index--) {
+        auto candidate = index - 1;
+        if (exclude_magical && entry.reference_is_magic_variable[candidate])
+            continue;
+        if (entry.reference_column[candidate] + entry.reference_length[candidate] <= column)
+            continue;
+        return entry.reference_at(candidate, file_id);
+    }
+    return std::nullopt;
+}
+
+std::vector<tables::t_reference> sqfvm::language_server::database::symbol_index::references_in_range(
+        uint64_t file_id,
+        uint64_t line_start,
+        uint64_t column_start,
+        uint64_t line_end,
+        uint64_t column_end) const {
+    std::shared_lock lock(m_mutex);
+    std::vector<t_reference> result;
+    auto file_it = m_files.find(file_id);
+    if (file_it == m_files.end())
+        return result;
+    const auto &entry = file_it->second;
+    auto begin = std::lower_bound(entry.reference_line.begin(), entry.reference_line.end(), line_start);
+    for (auto index = static_cast<size_t>(begin - entry.reference_line.begin());
+         index < entry.reference_line.size() && entry.reference_line[index] <= line_end;
+         index++) {
+        auto line = entry.reference_line[index];
+        auto column = entry.reference_column[index];
+        if (line == line_start && column < column_start)
+            continue;
+        if (line == line_end && column > column_end)
+            continue;
+        result.push_back(entry.reference_at(index, file_id));
+    }
+    return result;
+}
+
+std::vector<tables::t_reference> sqfvm::language_server::database::symbol_index::references_of_variable(
+        uint64_t variable_id) const {
+    std::shared_lock lock(m_mutex);
+    std::vector<t_reference> result;
+    auto variable_it = m_variable_files.find(variable_id);
+    if (variable_it == m_variable_files.end())
+        return result;
+    std::vector<uint64_t> file_ids(variable_it->second.begin(), variable_it->second.end());
+    std::sort(file_ids.begin(), file_ids.end());
+    for (auto file_id: file_ids) {
+        const auto &entry = m_files.at(file_id);
+        for (size_t index = 0; index < entry.reference_variable.size(); index++) {
+            if (entry.reference_variable[index] != variable_id)
+                continue;
+            // References are sorted by position, hence duplicates are always adjacent
+            if (!result.empty()
+                && result.back().file_fk == file_id
+                && result.back().line == entry.reference_line[index]
+                && result.back().column == entry.reference_column[index])
+                continue;
+            result.push_back(entry.reference_at(index, file_id));
+        }
+    }
+    return result;
+}
+
+std::optional<sqfvm::language_server::database::symbol_index::hover_result>
+sqfvm::language_server::database::symbol_index::innermost_hover_at(
+        uint64_t file_id,
+        uint64_t line,
+        uint64_t column) const {
+    std::shared_lock lock(m_mutex);
+    auto file_it = m_files.find(file_id);
+    if (file_it == m_files.end() || file_it->second.hover_id.empty())
+        return std::nullopt;
+    const auto &entry = file_it->second;
+    auto index = entry.hover_ranges.innermost(position_key(line, column));
+    if (!index.has_value())
+        return std::nullopt;
+    auto content_it = m_hover_contents.find(entry.hover_content[*index]);
+    return hover_result{
+            .hover = entry.hover_at(*index, file_id),
+            .markdown = content_it == m_hover_contents.end() ? std::string{} : content_it->second.markdown,
+    };
+}
+
+std::vector<tables::t_diagnostic> sqfvm::language_server::database::symbol_index::diagnostics_in(
+        uint64_t file_id) const {
+    std::shared_lock lock(m_mutex);
+    std::vector<t_diagnostic> result;
+    auto file_it = m_files.find(file_id);
+    if (file_it == m_files.end())
+        return result;
+    for (const auto &diagnostic: file_it->second.diagnostics) {
+        if (!diagnostic.is_suppressed)
+            result.push_back(diagnostic);
+    }
+    return result;
+}
+
+std::optional<tables::t_variable> sqfvm::language_server::database::symbol_index::variable(
+        uint64_t variable_id) const {
+    std::shared_lock lock(m_mutex);
+    auto variable_it = m_variables.find(variable_id);
+    if (variable_it == m_variables.end())
+        return std::nullopt;
+    return variable_it->second;
+}
+
+uint64_t sqfvm::language_server::database::symbol_index::generation_of(uint64_t file_id) const {
+    std::shared_lock lock(m_mutex);
+    auto file_it = m_files.find(file_id);
+    // Files without any rows are not indexed, the global generation covers them being emptied.
+    return file_it == m_files.end() ? m_generation : file_it->second.generation;
+}
+
+std::vector<tables::t_folding_range> sqfvm::language_server::database::symbol_index::folding_ranges_in(
+        uint64_t file_id) const {
+    std::shared_lock lock(m_mutex);
+    std::vector<t_folding_range> result;
+    auto file_it = m_files.find(file_id);
+    if (file_it == m_files.end())
+        return result;
+    const auto &entry = file_it->second;
+    result.reserve(entry.folding_start_line.size());
+    for (size_t i = 0; i < entry.folding_start_line.size(); i++) {
+        result.push_back({
+                .id_pk = 0,
+                .file_fk = file_id,
+                .start_line = entry.folding_start_line[i],
+                .end_line = entry.folding_end_line[i],
+                .kind = entry.folding_kind[i],
+        });
+    }
+    return result;
+}
+
+std::vector<uint32_t> sqfvm::language_server::database::symbol_index::semantic_tokens_of(uint64_t file_id) const {
+    std::shared_lock lock(m_mutex);
+    auto file_it = m_files.find(file_id);
+    if (file_it == m_files.end())
+        return {};
+    return file_it->second.semantic_tokens;
+}
+
+std::optional<std::string> sqfvm::language_server::database::symbol_index::file_path(uint64_t file_id) const {
+    std::shared_lock lock(m_mutex);
+    auto path_it = m_file_paths.find(file_id);
+    if (path_it == m_file_paths.end())
+        return std::nullopt;
+    return path_it->second;
+}
+
+std::vector<sqfvm::language_server::database::symbol_index::code_action_result>
+sqfvm::language_server::database::symbol_index::code_actions_in_range(
+        uint64_t file_id,
+        uint64_t line_start,
+        uint64_t column_start,
+        uint64_t line_end,
+        uint64_t column_end) const {
+    std::shared_lock lock(m_mutex);
+    std::vector<code_action_result> result;
+    auto file_it = m_files.find(file_id);
+    if (file_it == m_files.end())
+        return result;
+    const auto &entry = file_it->second;
+    std::vector<size_t> owners;
+    for (auto index: entry.code_action_ranges.intersecting(
+            position_key(line_start, column_start),
+            position_key(line_end, column_end))) {
+        owners.push_back(entry.code_action_range_owner[index]);
+    }
+    // Actions with multiple matching changes are reported once, in the order they were committed
+    std::sort(owners.begin(), owners.end());
+    owners.erase(std::unique(owners.begin(), owners.end()), owners.end());
+    for (auto owner: owners) {
+        result.push_back({entry.code_actions[owner], entry.code_action_changes[owner]});
+    }
+    return result;
+}
+
+std::optional<sqfvm::language_server::database::symbol_index::code_action_result>
+sqfvm::language_server::database::symbol_index::code_action(uint64_t file_id, uint64_t code_action_id) const {
+    std::shared_lock lock(m_mutex);
+    auto file_it = m_files.find(file_id);
+    if (file_it == m_files.end())
+        return std::nullopt;
+    const auto &entry = file_it->second;
+    auto action_it = std::lower_bound(
+            entry.code_actions.begin(),
+            entry.code_actions.end(),
+            code_action_id,
+            [](const t_code_action &it, uint64_t id) { return it.id_pk < id; });
+    if (action_it == entry.code_actions.end() || action_it->id_pk != code_action_id)
+        return std::nullopt;
+    auto index = static_cast<size_t>(action_it - entry.code_actions.begin());
+    return code_action_result{*action_it, entry.code_action_changes[index]};
+}
+
+std::vector<tables::t_variable> sqfvm::language_server::database::symbol_index::globals_with_prefix(
+        std::string_view scope,
+        std::string_view prefix,
+        size_t limit) const {
+    std::shared_lock lock(m_mutex);
+    std::vector<t_variable> result;
+    auto folded_prefix = fold_case(prefix);
+    auto folded_scope = fold_case(scope);
+    for (auto it = m_global_names.lower_bound(folded_prefix);
+         it != m_global_names.end() && it->first.starts_with(folded_prefix) && result.size() < limit;
+         ++it) {
+        // Different ids of the same name only differ in case or namespace, hence one is enough
+        for (auto variable_id: it->second) {
+            const auto &variable = m_variables.at(variable_id);
+            if (fold_case(variable.scope) != folded_scope)
+                continue;
+            result.push_back(variable);
+            break;
+        }
+    }
+    return result;
+}
+
+std::unordered_set<uint64_t> sqfvm::language_server::database::symbol_index::files_referencing_global(
+        std::string_view scope,
+        std::string_view name) const {
+    std::shared_lock lock(m_mutex);
+    std::unordered_set<uint64_t> result;
+    auto name_it = m_global_names.find(fold_case(name));
+    if (name_it == m_global_names.end())
+        return result;
+    auto folded_scope = fold_case(scope);
+    for (auto variable_id: name_it->second) {
+        if (fold_case(m_variables.at(variable_id).scope) != folded_scope)
+            continue;
+        auto files_it = m_variable_files.find(variable_id);
+        if (files_it != m_variable_files.end())
+            result.insert(files_it->second.begin(), files_it->second.end());
+    }
+    return result;
+}
+
+std::vector<tables::t_variable> sqfvm::language_server::database::symbol_index::privates_before(
+        uint64_t file_id,
+        uint64_t line,
+        uint64_t column,
+        std::string_view prefix) const {
+    std::shared_lock lock(m_mutex);
+    std::vector<t_variable> result;
+    auto file_it = m_files.find(file_id);
+    if (file_it == m_files.end())
+        return result;
+    const auto &entry = file_it->second;
+    auto folded_prefix = fold_case(prefix);
+    std::unordered_set<uint64_t> seen;
+    // References are sorted by position, walking backwards yields the closest ones first
+    auto end = static_cast<size_t>(std::upper_bound(
+            entry.reference_line.begin(), entry.reference_line.end(), line) - entry.reference_line.begin());
+    for (auto index = end; index > 0; index--) {
+        auto i = index - 1;
+        if (entry.reference_line[i] == line && entry.reference_column[i] > column)
+            continue;
+        auto variable_id = entry.reference_variable[i];
+        if (!seen.insert(variable_id).second)
+            continue;
+        auto variable_it = m_variables.find(variable_id);
+        if (variable_it == m_variables.end() || !variable_it->second.opt_scope_fk.has_value())
+            continue;
+        if (!fold_case(variable_it->second.variable_name).starts_with(folded_prefix))
+            continue;
+        result.push_back(variable_it->second);
+    }
+    return result;
+}
+
+std::vector<sqfvm::language_server::database::symbol_index::declaration_result>
+sqfvm::language_server::database::symbol_index::search_global_declarations(
+        std::string_view query,
+        size_t limit) const {
+    std::shared_lock lock(m_mutex);
+    std::vector<declaration_result> result;
+    auto variable_ids = m_global_trigrams.query(fold_case(query), limit, [&](uint64_t variable_id) {
+        return m_declaration_files.contains(variable_id);
+    });
+    for (auto variable_id: variable_ids) {
+        const auto &variable = m_variables.at(variable_id);
+        std::vector<uint64_t> file_ids(
+                m_declaration_files.at(variable_id).begin(),
+                m_declaration_files.at(variable_id).end());
+        std::sort(file_ids.begin(), file_ids.end());
+        for (auto file_id: file_ids) {
+            const auto &entry = m_files.at(file_id);
+            for (size_t i = 0; i < entry.reference_variable.size(); i++) {
+                if (entry.reference_variable[i] != variable_id || !entry.reference_is_declaration[i])
+                    continue;
+                if (result.size() >= limit)
+                    return result;
+                result.push_back({variable, entry.reference_at(i, file_id)});
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<tables::t_reference> sqfvm::language_server::database::symbol_index::declarations_of_variable(
+        uint64_t variable_id,
+        uint64_t relative_to_file_id) const {
+    std::shared_lock lock(m_mutex);
+    std::vector<t_reference> result;
+    auto declaration_it = m_declaration_files.find(variable_id);
+    if (declaration_it == m_declaration_files.end())
+        return result;
+    // The files including the given one are the ones its rows were discovered in
+    static const std::unordered_set<uint64_t> no_files;
+    auto relative_it = m_files.find(relative_to_file_id);
+    const auto &includers = relative_it == m_files.end() ? no_files : relative_it->second.source_files;
+    std::vector<std::pair<int, t_reference>> ranked;
+    for (auto file_id: declaration_it->second) {
+        const auto &entry = m_files.at(file_id);
+        for (size_t i = 0; i < entry.reference_variable.size(); i++) {
+            if (entry.reference_variable[i] != variable_id || !entry.reference_is_declaration[i])
+                continue;
+            auto reference = entry.reference_at(i, file_id);
+            int rank = 2;
+            if (file_id == relative_to_file_id)
+                rank = 0;
+            else if (includers.contains(file_id) || reference.source_file_fk == relative_to_file_id)
+                rank = 1;
+            ranked.emplace_back(rank, std::move(reference));
+        }
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const auto &l, const auto &r) {
+        return std::tie(l.first, l.second.file_fk, l.second.line, l.second.column)
+               < std::tie(r.first, r.second.file_fk, r.second.line, r.second.column);
+    });
+    result.reserve(ranked.size());
+    for (auto &[_, reference]: ranked) {
+        // Duplicates are adjacent after sorting, as they share file and position
+        if (!result.empty()
+            && result.back().file_fk == reference.file_fk
+            && result.back().line == reference.line
+            && result.back().column == reference.column)
+            continue;
+        result.push_back(std::move(reference));
+    }
+    return result;
+}
+
+std::vector<sqfvm::language_server::database::symbol_index::declaration_result>
+sqfvm::language_server::database::symbol_index::declarations_in(uint64_t file_id) const {
+    std::shared_lock lock(m_mutex);
+    std::vector<declaration_result> result;
+    auto file_it = m_files.find(file_id);
+    if (file_it == m_files.end())
+        return result;
+    const auto &entry = file_it->second;
+    for (size_t i = 0; i < entry.reference_variable.size(); i++) {
+        if (!entry.reference_is_declaration[i] || entry.reference_is_magic_variable[i])
+            continue;
+        auto variable_it = m_variables.find(entry.reference_variable[i]);
+        if (variable_it == m_variables.end())
+            continue;
+        result.push_back({variable_it->second, entry.reference_at(i, file_id)});
+    }
+    return result;
+}
+
+std::vector<tables::t_config_function> sqfvm::language_server::database::symbol_index::search_functions(
+        std::string_view query,
+        size_t limit) const {
+    std::shared_lock lock(m_mutex);
+    std::vector<t_config_function> result;
+    for (auto function_id: m_function_trigrams.query(fold_case(query), limit, [](uint64_t) { return true; })) {
+        result.push_back(m_functions.at(function_id));
+    }
+    return result;
+}
@@ -0,0 +1,321 @@
+#ifndef SQFVM_LANGUAGE_SERVER_DATABASE_SYMBOL_INDEX_HPP
+#define SQFVM_LANGUAGE_SERVER_DATABASE_SYMBOL_INDEX_HPP
+
+#include "context.hpp"
+#include "interval_index.hpp"
+#include "trigram_index.hpp"
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sqfvm::language_server::database {
+    // In-process index of the per-file analysis results, used to answer LSP queries without
+    // a round trip to SQLite. The database stays the source of truth: the index is loaded from it
+    // on startup and the affected files are re-read from it after every commit.
+    class symbol_index {
+    public:
+        // A hover together with the markdown of its t_hover_content.
+        struct hover_result {
+            tables::t_hover hover;
+            std::string markdown;
+        };
+
+        // A declaring reference together with the variable it declares.
+        struct declaration_result {
+            tables::t_variable variable;
+            tables::t_reference declaration;
+        };
+
+        // A code action together with all of its changes.
+        struct code_action_result {
+            tables::t_code_action code_action;
+            std::vector<tables::t_code_action_change> changes;
+        };
+
+        // Types of the semantic tokens produced for references, in the order of the LSP legend.
+        enum class semantic_token_type : uint32_t {
+            variable,
+            function,
+        };
+
+        // Modifiers of the semantic tokens produced for references, as bits in the order of the LSP legend.
+        enum semantic_token_modifier : uint32_t {
+            declaration = 1 << 0,
+            private_variable = 1 << 1,
+            global_variable = 1 << 2,
+            magic_variable = 1 << 3,
+            undefined_variable = 1 << 4,
+        };
+
+        // Columnar storage of everything known about a single file (file_fk).
+        // References are sorted by (line, column), hovers in the order of hover_ranges.
+        struct file_entry {
+            std::vector<uint64_t> reference_id;
+            std::vector<uint64_t> reference_source_file;
+            std::vector<uint64_t> reference_variable;
+            std::vector<uint64_t> reference_line;
+            std::vector<uint64_t> reference_column;
+            std::vector<uint64_t> reference_offset;
+            std::vector<uint64_t> reference_length;
+            std::vector<tables::t_reference::access_flags> reference_access;
+            std::vector<tables::t_reference::type_flags> reference_types;
+            std::vector<bool> reference_is_declaration;
+            std::vector<bool> reference_is_magic_variable;
+
+            std::vector<uint64_t> hover_id;
+            std::vector<uint64_t> hover_content;
+            // Positions encoded via position_key.
+            interval_index hover_ranges;
+
+            // Code actions sorted by id, row-wise as they are only materialized on request.
+            std::vector<tables::t_code_action> code_actions;
+            std::vector<std::vector<tables::t_code_action_change>> code_action_changes;
+            // The ranges of all changes with a position, encoded via position_key.
+            interval_index code_action_ranges;
+            // The index into code_actions for every range in code_action_ranges.
+            std::vector<size_t> code_action_range_owner;
+
+            // Folding ranges sorted by (start_line, end_line).
+            std::vector<uint64_t> folding_start_line;
+            std::vector<uint64_t> folding_end_line;
+            std::vector<tables::t_folding_range::range_kind> folding_kind;
+
+            // The references encoded as LSP semantic tokens (relative positions, five values per token).
+            // Produced by encode_semantic_tokens once the referenced variables are known.
+            std::vector<uint32_t> semantic_tokens;
+
+            // Diagnostics are only ever read as a whole, hence they are kept row-wise.
+            std::vector<tables::t_diagnostic> diagnostics;
+
+            // The source_file_fk's of all rows in this entry.
+            std::unordered_set<uint64_t> source_files;
+
+            // Value of symbol_index::m_generation when this entry was last refreshed.
+            uint64_t generation = 0;
+
+            [[nodiscard]] tables::t_reference reference_at(size_t index, uint64_t file_id) const;
+
+            [[nodiscard]] tables::t_hover hover_at(size_t index, uint64_t file_id) const;
+        };
+
+        // Encodes a (line, column) pair into a single, ordered value.
+        [[nodiscard]] static constexpr uint64_t position_key(uint64_t line, uint64_t column) {
+            return (line << 32) | (column & 0xFFFFFFFF);
+        }
+
+        // Returns the given name in lower case, as SQF identifiers are case-insensitive.
+        [[nodiscard]] static std::string fold_case(std::string_view name);
+
+    private:
+        mutable std::shared_mutex m_mutex;
+        bool m_loaded = false;
+        uint64_t m_generation = 0;
+        std::unordered_map<uint64_t, file_entry> m_files;
+        std::unordered_map<uint64_t, tables::t_variable> m_variables;
+
+        // Maps the id of every indexed file to its path.
+        std::unordered_map<uint64_t, std::string> m_file_paths;
+
+        // The markdown of a t_hover_content together with the amount of hovers in m_files referring to it.
+        struct hover_content_entry {
+            std::string markdown;
+            size_t references = 0;
+        };
+
+        // Maps a t_hover_content id to its markdown. Contents are shared across files, hence they are
+        // reference counted and dropped once no hover refers to them anymore.
+        std::unordered_map<uint64_t, hover_content_entry> m_hover_contents;
+
+        // Maps a source_file_fk to all file_fk's that hold rows discovered in it.
+        std::unordered_map<uint64_t, std::unordered_set<uint64_t>> m_derived_files;
+
+        // Maps a variable id to all file_fk's that hold references to it.
+        std::unordered_map<uint64_t, std::unordered_set<uint64_t>> m_variable_files;
+
+        // Maps the case-folded name of every global in m_variables to its ids, ordered to allow prefix lookups.
+        std::map<std::string, std::unordered_set<uint64_t>, std::less<>> m_global_names;
+
+        // The case-folded names of all globals in m_variables, keyed by variable id.
+        trigram_index m_global_trigrams;
+
+        // Maps a variable id to all file_fk's that hold declaring references to it.
+        std::unordered_map<uint64_t, std::unordered_set<uint64_t>> m_declaration_files;
+
+        // The functions of CfgFunctions by id, and the ids of those discovered in a file by its id.
+        std::unordered_map<uint64_t, tables::t_config_function> m_functions;
+        std::unordered_map<uint64_t, std::unordered_set<uint64_t>> m_source_functions;
+
+        // The case-folded names of all functions in m_functions, keyed by function id.
+        trigram_index m_function_trigrams;
+
+        // Removes the given file from the index. The ids of contents no longer referred to are appended to
+        // released_contents, they are kept until release_hover_contents(...) as a refill may refer to them again.
+        void unlink(uint64_t file_id, std::vector<uint64_t> &released_contents);
+
+        // Drops the given contents unless they are referred to again.
+        void release_hover_contents(const std::vector<uint64_t> &content_ids);
+
+        void link(uint64_t file_id);
+
+        void fill(
+                uint64_t file_id,
+                std::vector<tables::t_reference> references,
+                std::vector<tables::t_hover> hovers,
+                std::vector<tables::t_diagnostic> diagnostics,
+                std::vector<code_action_result> code_actions,
+                std::vector<tables::t_folding_range> folding_ranges);
+
+        // Replaces the functions discovered in the given file. Requires m_mutex to be held exclusively.
+        void set_functions(uint64_t source_file_id, std::vector<tables::t_config_function> functions);
+
+        static std::vector<tables::t_variable> query_variables(
+                context &ctx,
+                const std::unordered_set<uint64_t> &variable_ids);
+
+        // Adds the given variables of linked references. Requires m_mutex to be held exclusively.
+        void store_variables(std::vector<tables::t_variable> variables);
+
+        void encode_semantic_tokens(file_entry &entry) const;
+
+        void load_hover_contents(context &ctx, const std::unordered_set<uint64_t> &content_ids);
+
+        static std::vector<std::pair<uint64_t, std::string>> query_file_paths(
+                context &ctx,
+                const std::unordered_set<uint64_t> &file_ids);
+
+        // Replaces the paths of the given files. Requires m_mutex to be held exclusively.
+        void store_file_paths(
+                const std::unordered_set<uint64_t> &file_ids,
+                std::vector<std::pair<uint64_t, std::string>> paths);
+
+    public:
+        // Whether load(...) completed successfully at least once.
+        [[nodiscard]] bool loaded() const {
+            std::shared_lock lock(m_mutex);
+            return m_loaded;
+        }
+
+        // Replaces the whole index with the current database contents.
+        void load(context &ctx);
+
+        // Re-reads all rows that were discovered in the file with the given id, including rows that
+        // belong to other files (e.g. includes). Has to be called after every commit of an analyzer
+        // or any other change to the analysis tables.
+        // Returns the ids of all files whose rows were re-read.
+        std::vector<uint64_t> refresh(context &ctx, uint64_t source_file_id);
+
+        // Returns the ids of all files holding any rows.
+        [[nodiscard]] std::vector<uint64_t> file_ids() const;
+
+        // Returns all references located at the given 1-based line of the given file.
+        [[nodiscard]] std::vector<tables::t_reference> references_at_line(
+                uint64_t file_id,
+                uint64_t line,
+                bool exclude_magical) const;
+
+        // Returns the reference of the given file whose name spans the given 1-based position.
+        [[nodiscard]] std::optional<tables::t_reference> reference_at(
+                uint64_t file_id,
+                uint64_t line,
+                uint64_t column,
+                bool exclude_magical) const;
+
+        // Returns all references of the given file that start between the two 1-based positions (inclusive).
+        [[nodiscard]] std::vector<tables::t_reference> references_in_range(
+                uint64_t file_id,
+                uint64_t line_start,
+                uint64_t column_start,
+                uint64_t line_end,
+                uint64_t column_end) const;
+
+        // Returns all references, across all files, of the variable with the given id.
+        // The result is sorted by (file_fk, line, column) and contains every position only once.
+        [[nodiscard]] std::vector<tables::t_reference> references_of_variable(uint64_t variable_id) const;
+
+        // Returns the innermost hover of the given file containing the given 1-based position.
+        [[nodiscard]] std::optional<hover_result> innermost_hover_at(
+                uint64_t file_id,
+                uint64_t line,
+                uint64_t column) const;
+
+        // Returns all not suppressed diagnostics located in the given file, regardless of where they were discovered.
+        [[nodiscard]] std::vector<tables::t_diagnostic> diagnostics_in(uint64_t file_id) const;
+
+        // Returns up to limit declarations of globals whose name fuzzy-matches query, ignoring case.
+        // Declarations of better matching names come first.
+        [[nodiscard]] std::vector<declaration_result> search_global_declarations(
+                std::string_view query,
+                size_t limit) const;
+
+        // Returns up to limit functions of CfgFunctions whose name fuzzy-matches query, ignoring case.
+        // Better matching names come first.
+        [[nodiscard]] std::vector<tables::t_config_function> search_functions(
+                std::string_view query,
+                size_t limit) const;
+
+        // Returns all declaring references of the variable with the given id, ranked by their relation to the
+        // given file: declarations in that file first, then those in files it is included by or includes,
+        // then all others. Within a rank, declarations are ordered by (file_fk, line, column).
+        [[nodiscard]] std::vector<tables::t_reference> declarations_of_variable(
+                uint64_t variable_id,
+                uint64_t relative_to_file_id) const;
+
+        // Returns all declarations located in the given file, ordered by position.
+        [[nodiscard]] std::vector<declaration_result> declarations_in(uint64_t file_id) const;
+
+        // Returns all folding ranges of the given file, ordered by their start line.
+        [[nodiscard]] std::vector<tables::t_folding_range> folding_ranges_in(uint64_t file_id) const;
+
+        // Returns the semantic tokens of the given file, see file_entry::semantic_tokens.
+        [[nodiscard]] std::vector<uint32_t> semantic_tokens_of(uint64_t file_id) const;
+
+        // Returns the path of the indexed file with the given id.
+        [[nodiscard]] std::optional<std::string> file_path(uint64_t file_id) const;
+
+        // Returns all code actions of the given file with a change whose range intersects the given range.
+        // Positions are 0-based, as stored in t_code_action_change.
+        [[nodiscard]] std::vector<code_action_result> code_actions_in_range(
+                uint64_t file_id,
+                uint64_t line_start,
+                uint64_t column_start,
+                uint64_t line_end,
+                uint64_t column_end) const;
+
+        // Returns the code action with the given id of the given file.
+        [[nodiscard]] std::optional<code_action_result> code_action(uint64_t file_id, uint64_t code_action_id) const;
+
+        // Returns a value that changes whenever the rows of the given file change.
+        [[nodiscard]] uint64_t generation_of(uint64_t file_id) const;
+
+        // Returns the variable with the given id, if it is referenced by any indexed file.
+        [[nodiscard]] std::optional<tables::t_variable> variable(uint64_t variable_id) const;
+
+        // Returns up to limit globals of the given namespace whose name starts with prefix, ignoring case.
+        [[nodiscard]] std::vector<tables::t_variable> globals_with_prefix(
+                std::string_view scope,
+                std::string_view prefix,
+                size_t limit) const;
+
+        // Returns the ids of all files referencing a global of the given namespace with the given name, ignoring case.
+        [[nodiscard]] std::unordered_set<uint64_t> files_referencing_global(
+                std::string_view scope,
+                std::string_view name) const;
+
+        // Returns the privates referenced in the given file at or before the given 1-based position
+        // whose name starts with prefix, ignoring case. The most recently referenced come first.
+        [[nodiscard]] std::vector<tables::t_variable> privates_before(
+                uint64_t file_id,
+                uint64_t line,
+                uint64_t column,
+                std::string_view prefix) const;
+    };
+}
+
+#endif //SQFVM_LANGUAGE_SERVER_DATABASE_SYMBOL_INDEX_HPP
@@ -0,0 +1,57 @@
+#ifndef SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_CONFIG_CLASS_H
+#define SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_CONFIG_CLASS_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace sqfvm::language_server::database::tables {
+    // Represents a class declared in a config (e.g. config.cpp or description.ext).
+    // Classes are identified by their path, which is the case-folded names of all enclosing classes
+    // and the class itself, separated by '/' (e.g. "cfgfunctions/tag").
+    struct t_config_class {
+        static constexpr const char *table_name = "tConfigClass";
+
+        // The primary key of this t_config_class.
+        uint64_t id_pk;
+
+        // Foreign key referring to the t_file this is declared in.
+        uint64_t file_fk;
+
+        // Foreign key referring to the t_file this was discovered in.
+        uint64_t source_file_fk;
+
+        // The name of this class, as written.
+        std::string name;
+
+        // The path of this class.
+        std::string path;
+
+        // The path of the class this is declared in. Empty for classes declared at the root.
+        std::string parent_path;
+
+        // The name of the class this inherits from, as written. Empty if this does not inherit.
+        std::string base_name;
+
+        // The path of the class base_name resolved to. nullopt if this does not inherit or the base is undefined.
+        std::optional<std::string> opt_base_path;
+
+        // The line of the name of this class in the t_file referred to via file_fk.
+        uint64_t line;
+
+        // The column of the name of this class in the t_file referred to via file_fk.
+        uint64_t column;
+
+        // The offset of the name of this class in the t_file referred to via file_fk.
+        uint64_t offset;
+
+        // The line of base_name in the t_file referred to via file_fk. 0 if this does not inherit.
+        uint64_t base_line;
+
+        // The column of base_name in the t_file referred to via file_fk.
+        uint64_t base_column;
+    };
+}
+
+
+#endif //SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_CONFIG_CLASS_H
@@ -0,0 +1,42 @@
+#ifndef SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_CONFIG_FUNCTION_H
+#define SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_CONFIG_FUNCTION_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace sqfvm::language_server::database::tables {
+    // Represents a function declared in CfgFunctions, which the engine compiles into the global
+    // TAG_fnc_name (e.g. class CfgFunctions { class TAG { class Category { class name {}; }; }; }).
+    struct t_config_function {
+        static constexpr const char *table_name = "tConfigFunction";
+
+        // The primary key of this t_config_function.
+        uint64_t id_pk;
+
+        // Foreign key referring to the t_file this is declared in.
+        uint64_t file_fk;
+
+        // Foreign key referring to the t_file this was discovered in.
+        uint64_t source_file_fk;
+
+        // The name of the global this function is compiled into (e.g. TAG_fnc_name), as written.
+        std::string name;
+
+        // The physical path of the file implementing this function, as resolved from the file properties
+        // or the default functions\<category>\fn_<name>.sqf layout.
+        std::string path;
+
+        // Foreign key referring to the t_file at path. nullopt if the file does not exist.
+        std::optional<uint64_t> opt_target_file_fk;
+
+        // The line of the class declaring this function in the t_file referred to via file_fk.
+        uint64_t line;
+
+        // The column of the class declaring this function in the t_file referred to via file_fk.
+        uint64_t column;
+    };
+}
+
+
+#endif //SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_CONFIG_FUNCTION_H
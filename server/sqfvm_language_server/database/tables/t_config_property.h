@@ -0,0 +1,46 @@
+#ifndef SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_CONFIG_PROPERTY_H
+#define SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_CONFIG_PROPERTY_H
+
+#include <cstdint>
+#include <string>
+
+namespace sqfvm::language_server::database::tables {
+    // Represents a property (e.g. `file = "functions";`) declared in a config.
+    struct t_config_property {
+        static constexpr const char *table_name = "tConfigProperty";
+
+        // The primary key of this t_config_property.
+        uint64_t id_pk;
+
+        // Foreign key referring to the t_file this is declared in.
+        uint64_t file_fk;
+
+        // Foreign key referring to the t_file this was discovered in.
+        uint64_t source_file_fk;
+
+        // The path of the t_config_class this is declared in, see t_config_class::path.
+        // Empty for properties declared at the root.
+        std::string class_path;
+
+        // The name of this property, as written.
+        std::string name;
+
+        // The value of this property. Strings are unquoted, arrays are written as `{a, b}`.
+        std::string value;
+
+        // Whether this property extends an inherited array (`name[] += {...};`) instead of replacing it.
+        bool is_append;
+
+        // The line of the name of this property in the t_file referred to via file_fk.
+        uint64_t line;
+
+        // The column of the name of this property in the t_file referred to via file_fk.
+        uint64_t column;
+
+        // The offset of the name of this property in the t_file referred to via file_fk.
+        uint64_t offset;
+    };
+}
+
+
+#endif //SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_CONFIG_PROPERTY_H
@@ -0,0 +1,39 @@
+#ifndef SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_FOLDING_RANGE_H
+#define SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_FOLDING_RANGE_H
+
+#include <cstdint>
+
+namespace sqfvm::language_server::database::tables {
+    // Represents a foldable range of lines in a file.
+    struct t_folding_range {
+        static constexpr const char *table_name = "tFoldingRange";
+        enum range_kind {
+            // A code block, enclosed by curly braces.
+            code,
+
+            // An array, enclosed by square brackets.
+            array,
+
+            // A branch of a preprocessor #if, #ifdef or #ifndef.
+            preprocessor,
+        };
+
+        // The primary key of this t_folding_range
+        uint64_t id_pk;
+
+        // Foreign key referring to the t_file this belongs to.
+        uint64_t file_fk;
+
+        // The 0-based line where this range starts in the t_file referred to via file_fk.
+        uint64_t start_line;
+
+        // The 0-based line where this range ends in the t_file referred to via file_fk.
+        uint64_t end_line;
+
+        // What is folded by this range.
+        range_kind kind;
+    };
+}
+
+
+#endif //SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_FOLDING_RANGE_H
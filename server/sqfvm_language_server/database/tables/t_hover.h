@@ -27,8 +27,8 @@ namespace sqfvm::language_server::database::tables {
         // The column where this hover ends in the t_file referred to via file_fk.
         uint64_t end_column;
 
-        // The markdown content of this hover.
-        std::string markdown;
+        // Foreign key referring to the t_hover_content holding the markdown of this hover.
+        uint64_t content_fk;
     };
 }
 
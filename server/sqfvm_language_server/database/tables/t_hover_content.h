@@ -0,0 +1,24 @@
+#ifndef SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_HOVER_CONTENT_H
+#define SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_HOVER_CONTENT_H
+
+#include <cstdint>
+#include <string>
+
+namespace sqfvm::language_server::database::tables {
+    // Represents the markdown of one or more t_hover's, stored only once.
+    struct t_hover_content {
+        static constexpr const char *table_name = "tHoverContent";
+
+        // The primary key of this t_hover_content
+        uint64_t id_pk;
+
+        // The content hash of markdown, used to look up existing t_hover_content's.
+        int64_t hash;
+
+        // The markdown content of this hover.
+        std::string markdown;
+    };
+}
+
+
+#endif //SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_HOVER_CONTENT_H
@@ -0,0 +1,28 @@
+#ifndef SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_SCOPE_H
+#define SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_SCOPE_H
+
+#include <cstdint>
+#include <optional>
+
+namespace sqfvm::language_server::database::tables {
+    // Represents a scope (file or code block) private t_variable's live in.
+    struct t_scope {
+        static constexpr const char *table_name = "tScope";
+
+        // The primary key of this t_scope.
+        uint64_t id_pk;
+
+        // Foreign key referring to the t_file this belongs to.
+        uint64_t file_fk;
+
+        // Foreign key referring to the t_scope this is nested in. nullopt if this is the file scope.
+        std::optional<uint64_t> opt_parent_scope_fk;
+
+        // The index of this t_scope in order of appearance in the t_file referred to via file_fk.
+        // The file scope always has the ordinal 0.
+        uint64_t ordinal;
+    };
+}
+
+
+#endif //SQFVM_LANGUAGE_SERVER_DATABASE_TABLES_T_SCOPE_H
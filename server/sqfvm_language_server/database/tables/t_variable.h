@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <string>
 #include <optional>
+#include "t_reference.h"
 
 namespace sqfvm::language_server::database::tables {
     // Represents an entry of a variable, referable by multiple t_file's using t_reference
@@ -16,11 +17,18 @@ namespace sqfvm::language_server::database::tables {
         // The name of this t_variable.
         std::string variable_name;
 
-        // Either the scope-qualified name of this t_variable, or the namespace this t_variable belongs to.
+        // The namespace this t_variable belongs to. Empty if this t_variable is a private.
         std::string scope;
 
         // The file this t_variable belongs to. nullopt if this t_variable is a global.
         std::optional<uint64_t> opt_file_fk;
+
+        // The t_scope this t_variable belongs to. nullopt if this t_variable is a global.
+        std::optional<uint64_t> opt_scope_fk;
+
+        // The union of the types of all non-magic t_reference's to this t_variable, updated on commit.
+        // Only maintained for privates, none for globals.
+        t_reference::type_flags types;
     };
 }
 
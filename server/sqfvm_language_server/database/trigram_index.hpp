@@ -0,0 +1,151 @@
+#ifndef SQFVM_LANGUAGE_SERVER_DATABASE_TRIGRAM_INDEX_HPP
+#define SQFVM_LANGUAGE_SERVER_DATABASE_TRIGRAM_INDEX_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace sqfvm::language_server::database {
+    // Index of names by their trigrams (every substring of three characters), answering fuzzy
+    // queries without scanning all names. Names are expected to be case-folded already.
+    class trigram_index {
+        std::unordered_map<uint64_t, std::string> m_names;
+        std::unordered_map<uint32_t, std::unordered_set<uint64_t>> m_postings;
+
+        [[nodiscard]] static uint32_t trigram_at(std::string_view name, size_t index) {
+            return (static_cast<uint32_t>(static_cast<unsigned char>(name[index])) << 16)
+                   | (static_cast<uint32_t>(static_cast<unsigned char>(name[index + 1])) << 8)
+                   | static_cast<uint32_t>(static_cast<unsigned char>(name[index + 2]));
+        }
+
+        [[nodiscard]] static std::vector<uint32_t> trigrams_of(std::string_view name) {
+            std::vector<uint32_t> result;
+            for (size_t i = 0; i + 3 <= name.size(); i++) {
+                result.push_back(trigram_at(name, i));
+            }
+            std::sort(result.begin(), result.end());
+            result.erase(std::unique(result.begin(), result.end()), result.end());
+            return result;
+        }
+
+        // Whether all characters of query appear in name in the same order.
+        [[nodiscard]] static bool is_subsequence(std::string_view query, std::string_view name) {
+            size_t index = 0;
+            for (auto c: name) {
+                if (index < query.size() && query[index] == c)
+                    index++;
+            }
+            return index == query.size();
+        }
+
+        // Higher is better. Exact matches rank above prefixes, prefixes above substrings and
+        // substrings above names sharing only some trigrams.
+        [[nodiscard]] static double score(std::string_view query, std::string_view name, double trigram_ratio) {
+            if (name == query)
+                return 4.0;
+            if (name.starts_with(query))
+                return 3.0;
+            if (name.find(query) != std::string_view::npos)
+                return 2.0;
+            if (is_subsequence(query, name))
+                return 1.0 + trigram_ratio / 2;
+            return trigram_ratio;
+        }
+
+    public:
+        [[nodiscard]] size_t size() const { return m_names.size(); }
+
+        // Adds the given name under the given id, replacing any name previously added under it.
+        void insert(uint64_t id, std::string name) {
+            erase(id);
+            for (auto trigram: trigrams_of(name)) {
+                m_postings[trigram].insert(id);
+            }
+            m_names.emplace(id, std::move(name));
+        }
+
+        void erase(uint64_t id) {
+            auto name_it = m_names.find(id);
+            if (name_it == m_names.end())
+                return;
+            for (auto trigram: trigrams_of(name_it->second)) {
+                auto posting_it = m_postings.find(trigram);
+                if (posting_it == m_postings.end())
+                    continue;
+                posting_it->second.erase(id);
+                if (posting_it->second.empty())
+                    m_postings.erase(posting_it);
+            }
+            m_names.erase(name_it);
+        }
+
+        void clear() {
+            m_names.clear();
+            m_postings.clear();
+        }
+
+        // Returns the ids of all names matching query, best match first. A name matches if it shares
+        // at least half of the trigrams of query. Queries shorter than a trigram match names containing
+        // them as a subsequence instead. accept filters candidates before they are ranked.
+        template<typename TAccept>
+        [[nodiscard]] std::vector<uint64_t> query(std::string_view query, size_t limit, TAccept accept) const {
+            std::vector<std::pair<double, uint64_t>> ranked;
+            auto rank = [&](uint64_t id, const std::string &name, double trigram_ratio) {
+                if (!accept(id))
+                    return;
+                ranked.emplace_back(score(query, name, trigram_ratio), id);
+            };
+            if (query.size() < 3) {
+                for (const auto &[id, name]: m_names) {
+                    if (is_subsequence(query, name))
+                        rank(id, name, 0);
+                }
+            } else {
+                auto trigrams = trigrams_of(query);
+                std::unordered_map<uint64_t, size_t> hits;
+                for (auto trigram: trigrams) {
+                    auto posting_it = m_postings.find(trigram);
+                    if (posting_it == m_postings.end())
+                        continue;
+                    for (auto id: posting_it->second) {
+                        hits[id]++;
+                    }
+                }
+                auto required = (trigrams.size() + 1) / 2;
+                for (const auto &[id, count]: hits) {
+                    if (count < required)
+                        continue;
+                    rank(id, m_names.at(id), static_cast<double>(count) / static_cast<double>(trigrams.size()));
+                }
+            }
+            auto by_rank = [&](const auto &l, const auto &r) {
+                if (l.first != r.first)
+                    return l.first > r.first;
+                const auto &l_name = m_names.at(l.second);
+                const auto &r_name = m_names.at(r.second);
+                if (l_name.size() != r_name.size())
+                    return l_name.size() < r_name.size();
+                return l_name < r_name;
+            };
+            if (ranked.size() > limit) {
+                std::partial_sort(ranked.begin(), ranked.begin() + static_cast<ptrdiff_t>(limit), ranked.end(), by_rank);
+                ranked.resize(limit);
+            } else {
+                std::sort(ranked.begin(), ranked.end(), by_rank);
+            }
+            std::vector<uint64_t> result;
+            result.reserve(ranked.size());
+            for (const auto &[_, id]: ranked) {
+                result.push_back(id);
+            }
+            return result;
+        }
+    };
+}
+
+#endif //SQFVM_LANGUAGE_SERVER_DATABASE_TRIGRAM_INDEX_HPP
@@ -7,14 +7,18 @@
 #include "analysis/analyzer.hpp"
 #include "runtime/runtime.h"
 #include "database/context.hpp"
+#include "database/symbol_index.hpp"
 #include "file_system_watcher.hpp"
 
 #include <Poco/DirectoryWatcher.h>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <vector>
 #include <memory>
 #include <sstream>
 #include <functional>
+#include <set>
 
 namespace sqfvm::language_server {
     class language_server : public ::lsp::server {
@@ -23,11 +27,84 @@ namespace sqfvm::language_server {
         std::filesystem::path m_db_path;
         analysis::analyzer_factory m_analyzer_factory;
         std::shared_ptr<database::context> m_context;
+        database::symbol_index m_symbol_index;
         std::unordered_map<::lsp::data::document_uri, ::lsp::data::integer> m_versions;
+
+        // Inlay hints of a single reference, kept with the position of the reference to filter by range.
+        struct cached_inlay_hint {
+            uint64_t line;
+            uint64_t column;
+            ::lsp::data::inlay_hint hint;
+        };
+        struct inlay_hint_cache_entry {
+            std::optional<::lsp::data::integer> version;
+            uint64_t generation;
+            // Hints by bucket, each bucket covering inlay_hint_bucket_lines lines.
+            std::unordered_map<uint64_t, std::vector<cached_inlay_hint>> buckets;
+        };
+        static constexpr uint64_t inlay_hint_bucket_lines = 64;
+        std::unordered_map<uint64_t, inlay_hint_cache_entry> m_inlay_hint_cache;
+
+        // Semantic tokens per file, together with the ones they replaced to answer delta requests against those.
+        struct semantic_tokens_cache_entry {
+            std::optional<::lsp::data::integer> version;
+            uint64_t generation;
+            std::string result_id;
+            std::vector<uint32_t> data;
+            std::string previous_result_id;
+            std::vector<uint32_t> previous_data;
+        };
+        std::unordered_map<uint64_t, semantic_tokens_cache_entry> m_semantic_tokens_cache;
+        uint64_t m_semantic_tokens_result_id = 0;
+
+        // Files whose diagnostics have to be published on the next publish_queued_diagnostics call.
+        std::set<uint64_t> m_queued_diagnostics;
+        // Diagnostics last published per file, used to skip sending unchanged sets.
+        struct published_diagnostics {
+            ::lsp::data::uri uri;
+            // Hash of json, compared first to skip comparing the full json of changed sets.
+            size_t fingerprint;
+            // The published diagnostics, serialized to json.
+            std::string json;
+            // Whether the client was last sent an empty set, allowing to forget the entry once the file closes.
+            bool is_empty;
+        };
+        std::unordered_map<uint64_t, published_diagnostics> m_published_diagnostics;
+        std::mutex m_diagnostics_mutex;
+
+        // Files deleted by the file system watcher, whose cached entries are dropped on the listen thread.
+        std::vector<uint64_t> m_deleted_file_ids;
+        std::mutex m_deleted_file_ids_mutex;
+
+        // Completion candidate of an SQF-VM operator, covering all of its overloads.
+        struct operator_completion {
+            std::string folded_name;
+            std::string name;
+            std::string description;
+        };
+        // Sorted by folded_name.
+        std::vector<operator_completion> m_operator_completions;
+        static constexpr size_t completion_item_limit = 200;
+        static constexpr size_t workspace_symbol_limit = 256;
+
+        // Contents of the open documents, used to find the word being completed.
+        std::unordered_map<::lsp::data::document_uri, std::string> m_document_contents;
+
+        // Maps a file id to its path and the uri created from it.
+        std::unordered_map<uint64_t, std::pair<std::string, ::lsp::data::uri>> m_file_uris;
         sqfvm_factory m_sqfvm_factory;
         file_system_watcher m_file_system_watcher;
         std::mutex m_analyze_mutex;
 
+        // Whether files got outdated while analyzing, requiring another pass of analyze_outdated_files.
+        bool m_outdated_during_analysis = false;
+
+        // Whether the database changed since the last maintenance run.
+        std::atomic<bool> m_maintenance_due = true;
+
+        // Time without any incoming message after which the database maintenance runs.
+        static constexpr std::chrono::milliseconds maintenance_idle_delay = std::chrono::seconds(30);
+
         database::context::operations::errlogfnc_t context_err_log() {
             return [this](const std::string &message) {
                 window_logMessage(
@@ -45,12 +122,75 @@ namespace sqfvm::language_server {
 
         void mark_related_files_as_outdated(const sqfvm::language_server::database::tables::t_file &file);
 
+        // Marks the configs deriving from a class that was added, removed or whose base changed as outdated,
+        // comparing the classes discovered in a file before and after it changed. Bases in other files are
+        // resolved when the deriving config is analyzed, hence it has to be analyzed again.
+        void mark_derived_configs_as_outdated(
+                uint64_t file_id,
+                const std::vector<database::tables::t_config_class> &old_classes,
+                const std::vector<database::tables::t_config_class> &new_classes);
+
+        // Marks the files calling a CfgFunctions function that was added, removed, renamed or moved to another
+        // file as outdated, comparing the functions discovered in a file before and after it changed.
+        void mark_callers_of_changed_functions_as_outdated(
+                uint64_t file_id,
+                const std::vector<database::tables::t_config_function> &old_functions,
+                const std::vector<database::tables::t_config_function> &new_functions);
+
         void analyse_file(const database::tables::t_file &file);
 
-        void publish_diagnostics(const database::tables::t_file &file, bool publish_sub_files = true);
+        void queue_diagnostics(uint64_t file_id);
+
+        // Publishes the diagnostics of all queued files whose diagnostics changed since they were last published.
+        void publish_queued_diagnostics();
 
         void analyze_outdated_files();
 
+        void refresh_symbol_index(uint64_t source_file_id);
+
+        // Drops the inlay hints, semantic tokens and uri cached for the file. Must run on the listen thread.
+        void forget_cached_file(uint64_t file_id);
+
+        // Calls forget_cached_file for all files deleted since the last call.
+        void forget_deleted_files();
+
+        std::vector<cached_inlay_hint> compute_inlay_hints(uint64_t file_id, uint64_t bucket);
+
+        std::optional<::lsp::data::uri> file_uri_of(uint64_t file_id);
+
+        // Returns the semantic tokens cache entry of the given document, refreshed if the document or its
+        // analysis results changed.
+        std::optional<std::reference_wrapper<semantic_tokens_cache_entry>> semantic_tokens_of(
+                const ::lsp::data::text_document_identifier &text_document);
+
+        std::optional<std::vector<::lsp::data::location>> declarations_at(
+                const ::lsp::data::text_document_identifier &text_document,
+                const ::lsp::data::position &position);
+
+        // Returns the declarations of the base class whose name is at the given position of a config file.
+        std::optional<std::vector<::lsp::data::location>> config_base_declarations_at(
+                uint64_t file_id,
+                const ::lsp::data::position &position);
+
+        // Returns the locations of the given CfgFunctions function: the start of the file implementing it,
+        // if that exists, followed by the class declaring it.
+        std::vector<::lsp::data::location> config_function_locations_of(
+                const database::tables::t_config_function &function);
+
+        std::optional<::lsp::data::symbol_information> symbol_information_of(
+                const database::symbol_index::declaration_result &declaration);
+
+        ::lsp::data::workspace_edit code_action_edit(const std::vector<database::tables::t_code_action_change> &changes);
+
+        // Whether the client announced to resolve the edit of code actions via codeAction/resolve.
+        [[nodiscard]] bool client_resolves_code_action_edits() const;
+
+        void register_custom_methods();
+
+        void load_operator_completions(const sqf::runtime::runtime &runtime);
+
+        void log_database_statistics();
+
         void push_file_history(
                 const ::sqfvm::language_server::database::tables::t_file &file,
                 std::string contents,
@@ -90,9 +230,29 @@ namespace sqfvm::language_server {
 
         void on_textDocument_didChange(const ::lsp::data::did_change_text_document_params &params) override;
 
+        void on_textDocument_didClose(const ::lsp::data::did_close_text_document_params &params) override;
+
         std::optional<std::vector<lsp::data::location>>
         on_textDocument_references(const lsp::data::references_params &params) override;
 
+        std::optional<lsp::data::semantic_tokens>
+        on_textDocument_semanticTokens_full(const lsp::data::semantic_tokens_params &params) override;
+
+        std::optional<std::variant<lsp::data::semantic_tokens, lsp::data::semantic_tokens_delta>>
+        on_textDocument_semanticTokens_full_delta(const lsp::data::semantic_tokens_delta_params &params) override;
+
+        std::optional<std::vector<lsp::data::location>>
+        on_textDocument_definition(const lsp::data::definition_params &params) override;
+
+        std::optional<std::vector<lsp::data::location>>
+        on_textDocument_declaration(const lsp::data::declaration_params &params) override;
+
+        std::optional<std::vector<lsp::data::symbol_information>>
+        on_textDocument_documentSymbol(const lsp::data::document_symbol_params &params) override;
+
+        std::optional<std::vector<lsp::data::symbol_information>>
+        on_workspace_symbol(const lsp::data::workspace_symbol_params &params) override;
+
 
         std::optional<std::vector<::lsp::data::folding_range>>
         on_textDocument_foldingRange(const ::lsp::data::folding_range_params &params) override;
@@ -100,14 +260,20 @@ namespace sqfvm::language_server {
         std::optional<::lsp::data::completion_list>
         on_textDocument_completion(const ::lsp::data::completion_params &params) override;
 
+        ::lsp::data::completion_item on_completionItem_resolve(const ::lsp::data::completion_item &params) override;
+
         std::optional<std::vector<std::variant<lsp::data::command, lsp::data::code_action>>>
         on_textDocument_codeAction(const lsp::data::code_action_params &params) override;
 
+        lsp::data::code_action on_codeAction_resolve(const lsp::data::code_action &params) override;
+
         std::optional<std::vector<lsp::data::inlay_hint>>
         on_textDocument_inlayHint(const lsp::data::inlay_hint_params &params) override;
 
         std::optional<lsp::data::hover> on_textDocument_hover(const lsp::data::hover_params &params) override;
 
+        void on_idle(std::chrono::milliseconds idle_time) override;
+
     public:
         language_server();
         language_server(jsonrpc&& rpc);
@@ -2,12 +2,18 @@
 
 #include "analysis/sqf_ast/sqf_ast_analyzer.hpp"
 #include "analysis/config_ast/config_ast_analyzer.hpp"
+#include "analysis/sqf_ast/visitors/scripted_visitor.hpp"
+#include "database/row_diff.hpp"
 
 
+#include <algorithm>
 #include <string_view>
 #include <fstream>
+#include <iterator>
+#include <tuple>
 #include <utility>
 #include <vector>
+#include <map>
 #include <set>
 #include <sstream>
 
@@ -47,15 +53,138 @@ void sqfvm::language_server::language_server::log_sqlite_migration_report() {
     window_logMessage(lsp::data::message_type::Log, sstream.str());
 }
 
-void sqfvm::language_server::language_server::analyze_outdated_files() {
-    if (!database::context::operations::for_each_file_outdated_and_not_deleted(
-            *m_context,
-            context_err_log(),
-            [&](auto &file) {
-                analyse_file(file);
-                return false;
-            }))
+void sqfvm::language_server::language_server::refresh_symbol_index(uint64_t source_file_id) {
+    try {
+        for (auto file_id: m_symbol_index.refresh(*m_context, source_file_id)) {
+            queue_diagnostics(file_id);
+        }
+    }
+    catch (std::exception &e) {
+        window_log(::lsp::data::message_type::Error, [&](auto &sstream) {
+            sstream << "Failed to refresh symbol index for file with id " << source_file_id << ": " << e.what();
+        });
+    }
+}
+
+void sqfvm::language_server::language_server::log_database_statistics() {
+    auto [success, statistics] = database::context::operations::get_statistics(*m_context, context_err_log());
+    if (!success)
         return;
+    window_log(::lsp::data::message_type::Log, [&](auto &sstream) {
+        sstream << "SQLITE database statistics:\n";
+        for (const auto &table: statistics.tables) {
+            sstream << table.name << ": " << table.rows << " rows";
+            if (table.bytes.has_value())
+                sstream << ", " << table.bytes.value() << " bytes";
+            sstream << "\n";
+        }
+        sstream << "File size: " << statistics.file_bytes << " bytes, " << statistics.free_bytes << " bytes free";
+    });
+}
+
+void sqfvm::language_server::language_server::load_operator_completions(const sqf::runtime::runtime &runtime) {
+    std::unordered_map<std::string, operator_completion> operators;
+    auto add = [&](const auto &op) {
+        auto folded_name = database::symbol_index::fold_case(op.name());
+        auto &completion = operators[folded_name];
+        if (completion.name.empty()) {
+            completion.folded_name = folded_name;
+            completion.name = std::string(op.name());
+        }
+        auto description = std::string(op.description());
+        if (description.empty() || completion.description.find(description) != std::string::npos)
+            return;
+        if (!completion.description.empty())
+            completion.description.append("\n\n---\n\n");
+        completion.description.append(description);
+    };
+    for (auto it = runtime.sqfop_nular_begin(); it != runtime.sqfop_nular_end(); ++it) {
+        add(it->second);
+    }
+    for (auto it = runtime.sqfop_unary_begin(); it != runtime.sqfop_unary_end(); ++it) {
+        add(it->second);
+    }
+    for (auto it = runtime.sqfop_binary_begin(); it != runtime.sqfop_binary_end(); ++it) {
+        add(it->second);
+    }
+    m_operator_completions.clear();
+    m_operator_completions.reserve(operators.size());
+    for (auto &[_, completion]: operators) {
+        m_operator_completions.push_back(std::move(completion));
+    }
+    std::sort(m_operator_completions.begin(), m_operator_completions.end(), [](const auto &l, const auto &r) {
+        return l.folded_name < r.folded_name;
+    });
+}
+
+void sqfvm::language_server::language_server::on_idle(std::chrono::milliseconds idle_time) {
+    forget_deleted_files();
+    if (!m_maintenance_due || idle_time < maintenance_idle_delay)
+        return;
+    if (!m_context || !m_context->good())
+        return;
+    // Analysis takes precedence, maintenance is retried on the next idle call
+    std::unique_lock<std::mutex> lock(m_analyze_mutex, std::try_to_lock);
+    if (!lock.owns_lock())
+        return;
+    m_maintenance_due = false;
+    auto [success, result] = database::context::operations::run_maintenance(*m_context, context_err_log());
+    if (!success)
+        return;
+    window_log(::lsp::data::message_type::Log, [&](auto &sstream) {
+        sstream << "SQLITE maintenance: removed " << result.removed_variables << " orphaned variables and "
+                << result.removed_hover_contents << " orphaned hover contents, released "
+                << result.vacuumed_pages << " free pages.";
+    });
+    log_database_statistics();
+}
+
+void sqfvm::language_server::language_server::register_custom_methods() {
+    m_rpc.register_method(
+            "sqfvm/databaseStatistics", [&](jsonrpc &rpc, const jsonrpc::rpcmessage &msg) {
+                if (!m_context || !m_context->good()) {
+                    rpc.send({msg.id, nlohmann::json(nullptr)});
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(m_analyze_mutex);
+                auto [success, statistics] = database::context::operations::get_statistics(
+                        *m_context,
+                        context_err_log());
+                if (!success) {
+                    rpc.send({msg.id, nlohmann::json(nullptr)});
+                    return;
+                }
+                auto tables = nlohmann::json::array();
+                for (const auto &table: statistics.tables) {
+                    tables.push_back({
+                            {"name",  table.name},
+                            {"rows",  table.rows},
+                            {"bytes", table.bytes.has_value() ? nlohmann::json(table.bytes.value()) : nlohmann::json(nullptr)},
+                    });
+                }
+                rpc.send({msg.id, nlohmann::json{
+                        {"tables",    tables},
+                        {"fileBytes", statistics.file_bytes},
+                        {"freeBytes", statistics.free_bytes},
+                }});
+            });
+}
+
+void sqfvm::language_server::language_server::analyze_outdated_files() {
+    // Failures are logged by the operation, files analyzed up to that point still get their diagnostics published
+    // Changed configs outdate the configs deriving from their classes and the callers of their functions,
+    // which are analyzed in another pass
+    do {
+        m_outdated_during_analysis = false;
+        std::ignore = database::context::operations::for_each_file_outdated_and_not_deleted(
+                *m_context,
+                context_err_log(),
+                [&](auto &file) {
+                    analyse_file(file);
+                    return false;
+                });
+    } while (m_outdated_during_analysis);
+    publish_queued_diagnostics();
 }
 
 std::optional<::sqfvm::language_server::database::tables::t_file>
@@ -121,6 +250,7 @@ void sqfvm::language_server::language_server::push_file_history(
 
 
 sqfvm::language_server::language_server::language_server() : m_sqfvm_factory(this) {
+    register_custom_methods();
     m_analyzer_factory.set(
             ".sqf", [](
                     auto ls_path,
@@ -167,6 +297,7 @@ sqfvm::language_server::language_server::language_server() : m_sqfvm_factory(thi
 
 sqfvm::language_server::language_server::language_server(jsonrpc &&rpc) : server(std::move(rpc)),
                                                                           m_sqfvm_factory(this) {
+    register_custom_methods();
     m_analyzer_factory.set(
             ".sqf", [](
                     auto ls_path,
@@ -263,6 +394,14 @@ bool sqfvm::language_server::language_server::delete_file(const std::filesystem:
 void sqfvm::language_server::language_server::delete_file(sqfvm::language_server::database::tables::t_file file) {
     using namespace sqfvm::language_server::database::tables;
     mark_related_files_as_outdated(file);
+    mark_derived_configs_as_outdated(
+            file.id_pk,
+            m_context->storage().get_all<t_config_class>(where(c(&t_config_class::source_file_fk) == file.id_pk)),
+            {});
+    mark_callers_of_changed_functions_as_outdated(
+            file.id_pk,
+            m_context->storage().get_all<t_config_function>(where(c(&t_config_function::source_file_fk) == file.id_pk)),
+            {});
     file.is_deleted = true;
     m_context->storage().update<t_file>(file);
     m_context->storage().remove_all<t_diagnostic>(
@@ -279,9 +418,61 @@ void sqfvm::language_server::language_server::delete_file(sqfvm::language_server
                   or c(&t_file_include::source_file_fk) == file.id_pk));
     m_context->storage().remove_all<t_hover>(
             where(c(&t_hover::file_fk) == file.id_pk));
+    m_context->storage().remove_all<t_hover_content>(
+            where(not_in(&t_hover_content::id_pk, select(&t_hover::content_fk))));
     m_context->storage().remove_all<t_variable>(
             where(c(&t_variable::opt_file_fk) == file.id_pk));
-    publish_diagnostics(file);
+    m_context->storage().remove_all<t_scope>(
+            where(c(&t_scope::file_fk) == file.id_pk));
+    m_context->storage().remove_all<t_folding_range>(
+            where(c(&t_folding_range::file_fk) == file.id_pk));
+    m_context->storage().remove_all<t_config_function>(
+            where(c(&t_config_function::file_fk) == file.id_pk
+                  or c(&t_config_function::source_file_fk) == file.id_pk));
+    m_context->storage().update_all(
+            set(c(&t_config_function::opt_target_file_fk) = std::optional<uint64_t>{}),
+            where(c(&t_config_function::opt_target_file_fk) == file.id_pk));
+    m_context->storage().remove_all<t_config_property>(
+            where(c(&t_config_property::file_fk) == file.id_pk
+                  or c(&t_config_property::source_file_fk) == file.id_pk));
+    m_context->storage().remove_all<t_config_class>(
+            where(c(&t_config_class::file_fk) == file.id_pk
+                  or c(&t_config_class::source_file_fk) == file.id_pk));
+    refresh_symbol_index(file.id_pk);
+    m_maintenance_due = true;
+
+    {
+        std::lock_guard<std::mutex> lock(m_diagnostics_mutex);
+        m_queued_diagnostics.erase(file.id_pk);
+        auto published_it = m_published_diagnostics.find(file.id_pk);
+        if (published_it != m_published_diagnostics.end()) {
+            // Clear what the client still shows for the file, nothing will publish for it anymore
+            if (!published_it->second.is_empty) {
+                lsp::data::publish_diagnostics_params params = {};
+                params.uri = published_it->second.uri;
+                textDocument_publishDiagnostics(params);
+            }
+            m_published_diagnostics.erase(published_it);
+        }
+    }
+    std::lock_guard<std::mutex> lock(m_deleted_file_ids_mutex);
+    m_deleted_file_ids.push_back(file.id_pk);
+}
+
+void sqfvm::language_server::language_server::forget_cached_file(uint64_t file_id) {
+    m_inlay_hint_cache.erase(file_id);
+    m_semantic_tokens_cache.erase(file_id);
+    m_file_uris.erase(file_id);
+}
+
+void sqfvm::language_server::language_server::forget_deleted_files() {
+    std::vector<uint64_t> file_ids;
+    {
+        std::lock_guard<std::mutex> lock(m_deleted_file_ids_mutex);
+        file_ids.swap(m_deleted_file_ids);
+    }
+    for (auto file_id: file_ids)
+        forget_cached_file(file_id);
 }
 
 void sqfvm::language_server::language_server::mark_related_files_as_outdated(
@@ -309,6 +500,18 @@ void sqfvm::language_server::language_server::mark_related_files_as_outdated(
         }
     }
 
+    // Functions of CfgFunctions are compiled by the engine rather than assigned in their file, hence their
+    // callers are only related through the functions this file implements. Changes of the config declaring
+    // them are handled by mark_callers_of_changed_functions_as_outdated.
+    auto functions = m_context->storage().get_all<database::tables::t_config_function>(
+            where(c(&database::tables::t_config_function::opt_target_file_fk) == file.id_pk));
+    for (const auto &function: functions) {
+        for (auto caller_id: m_symbol_index.files_referencing_global("missionNamespace", function.name)) {
+            if (caller_id != file.id_pk)
+                outdated_file_ids.insert(caller_id);
+        }
+    }
+
     // Mark all files as outdated
     for (const auto &outdated_file_id: outdated_file_ids) {
         auto outdated_file = m_context->storage().get<database::tables::t_file>(outdated_file_id);
@@ -318,6 +521,104 @@ void sqfvm::language_server::language_server::mark_related_files_as_outdated(
 
 }
 
+void sqfvm::language_server::language_server::mark_derived_configs_as_outdated(
+        uint64_t file_id,
+        const std::vector<database::tables::t_config_class> &old_classes,
+        const std::vector<database::tables::t_config_class> &new_classes) {
+    using database::tables::t_config_class;
+    std::map<std::string, std::optional<std::string>> old_bases;
+    for (const auto &config_class: old_classes) {
+        old_bases.emplace(config_class.path, config_class.opt_base_path);
+    }
+    std::map<std::string, std::optional<std::string>> new_bases;
+    for (const auto &config_class: new_classes) {
+        new_bases.emplace(config_class.path, config_class.opt_base_path);
+    }
+
+    // Classes resolved against a removed class or one whose inheritance changed have to be resolved again,
+    // undefined bases may resolve to an added class. The latter are matched by the name of the class only.
+    std::vector<std::string> changed_paths;
+    for (const auto &[path, base]: old_bases) {
+        auto new_it = new_bases.find(path);
+        if (new_it == new_bases.end() || new_it->second != base)
+            changed_paths.push_back(path);
+    }
+    std::set<std::string> added_names;
+    for (const auto &[path, _]: new_bases) {
+        if (old_bases.contains(path))
+            continue;
+        auto slash = path.rfind('/');
+        added_names.insert(slash == std::string::npos ? path : path.substr(slash + 1));
+    }
+
+    std::set<uint64_t> outdated_file_ids{};
+    database::for_each_chunk(
+            changed_paths,
+            database::max_bound_parameters,
+            [&](const std::vector<std::string> &chunk) {
+                for (auto source_file_id: m_context->storage().select(
+                        distinct(&t_config_class::source_file_fk),
+                        where(in(&t_config_class::opt_base_path, chunk)
+                              and c(&t_config_class::source_file_fk) != file_id))) {
+                    outdated_file_ids.insert(source_file_id);
+                }
+            });
+    if (!added_names.empty()) {
+        for (const auto &config_class: m_context->storage().get_all<t_config_class>(
+                where(is_null(&t_config_class::opt_base_path)
+                      and c(&t_config_class::base_name) != ""
+                      and c(&t_config_class::source_file_fk) != file_id))) {
+            if (added_names.contains(database::symbol_index::fold_case(config_class.base_name)))
+                outdated_file_ids.insert(config_class.source_file_fk);
+        }
+    }
+    for (const auto &outdated_file_id: outdated_file_ids) {
+        auto outdated_file = m_context->storage().get<database::tables::t_file>(outdated_file_id);
+        if (outdated_file.is_outdated)
+            continue;
+        outdated_file.is_outdated = true;
+        m_context->storage().update(outdated_file);
+        m_outdated_during_analysis = true;
+    }
+}
+
+void sqfvm::language_server::language_server::mark_callers_of_changed_functions_as_outdated(
+        uint64_t file_id,
+        const std::vector<database::tables::t_config_function> &old_functions,
+        const std::vector<database::tables::t_config_function> &new_functions) {
+    auto identities_of = [](const std::vector<database::tables::t_config_function> &functions) {
+        std::set<std::pair<std::string, std::string>> identities;
+        for (const auto &function: functions) {
+            identities.emplace(database::symbol_index::fold_case(function.name), function.path);
+        }
+        return identities;
+    };
+    auto old_identities = identities_of(old_functions);
+    auto new_identities = identities_of(new_functions);
+    std::vector<std::pair<std::string, std::string>> changed;
+    std::set_symmetric_difference(
+            old_identities.begin(), old_identities.end(),
+            new_identities.begin(), new_identities.end(),
+            std::back_inserter(changed));
+
+    // Callers of removed or renamed functions are found by the old name, which they still reference
+    std::set<uint64_t> outdated_file_ids{};
+    for (const auto &[name, _]: changed) {
+        for (auto caller_id: m_symbol_index.files_referencing_global("missionNamespace", name)) {
+            if (caller_id != file_id)
+                outdated_file_ids.insert(caller_id);
+        }
+    }
+    for (const auto &outdated_file_id: outdated_file_ids) {
+        auto outdated_file = m_context->storage().get<database::tables::t_file>(outdated_file_id);
+        if (outdated_file.is_outdated)
+            continue;
+        outdated_file.is_outdated = true;
+        m_context->storage().update(outdated_file);
+        m_outdated_during_analysis = true;
+    }
+}
+
 void sqfvm::language_server::language_server::analyse_file(
         const sqfvm::language_server::database::tables::t_file &file) {
     uint64_t timestamp = (uint64_t) std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -358,7 +659,8 @@ void sqfvm::language_server::language_server::analyse_file(
         }
     }
     // if extension is either .cpp or .ext, skip the file at the given path unless it's filename is either config.cpp or description.ext
-    if ((extension == ".cpp" || extension == ".ext")) {
+    auto is_config = extension == ".cpp" || extension == ".ext";
+    if (is_config) {
         auto filename = std::filesystem::path(file.path).filename().string();
         if (!iequal(filename, "config.cpp") && !iequal(filename, "description.ext"))
             return;
@@ -381,7 +683,27 @@ void sqfvm::language_server::language_server::analyse_file(
     try {
         if (!file_ignored) {
             analyzer_opt.value()->analyze();
+            std::vector<database::tables::t_config_class> old_classes;
+            std::vector<database::tables::t_config_function> old_functions;
+            if (is_config) {
+                old_classes = m_context->storage().get_all<database::tables::t_config_class>(
+                        where(c(&database::tables::t_config_class::source_file_fk) == file.id_pk));
+                old_functions = m_context->storage().get_all<database::tables::t_config_function>(
+                        where(c(&database::tables::t_config_function::source_file_fk) == file.id_pk));
+            }
             analyzer_opt.value()->commit();
+            if (is_config) {
+                mark_derived_configs_as_outdated(
+                        file.id_pk,
+                        old_classes,
+                        m_context->storage().get_all<database::tables::t_config_class>(
+                                where(c(&database::tables::t_config_class::source_file_fk) == file.id_pk)));
+                mark_callers_of_changed_functions_as_outdated(
+                        file.id_pk,
+                        old_functions,
+                        m_context->storage().get_all<database::tables::t_config_function>(
+                                where(c(&database::tables::t_config_function::source_file_fk) == file.id_pk)));
+            }
         }
     }
     catch (std::exception &e) {
@@ -398,57 +720,83 @@ void sqfvm::language_server::language_server::analyse_file(
                 .code = "VV-ERR",
         });
     }
-    try {
-        publish_diagnostics(file);
-    }
-    catch (std::exception &e) {
-        window_log(::lsp::data::message_type::Error, [&](auto &sstream) {
-            sstream << "Failed to publish diagnostics for '" << file.path << "': " << e.what();
-        });
-    }
+    refresh_symbol_index(file.id_pk);
+    m_maintenance_due = true;
 }
 
-void sqfvm::language_server::language_server::publish_diagnostics(
-        const sqfvm::language_server::database::tables::t_file &file,
-        bool publish_sub_files) {
-    auto file_diagnostics = m_context->storage().get_all<database::tables::t_diagnostic>(
-            where((c(&database::tables::t_diagnostic::source_file_fk) == file.id_pk
-                   or c(&database::tables::t_diagnostic::file_fk) == file.id_pk)
-                  and c(&database::tables::t_diagnostic::is_suppressed) == false));
-    lsp::data::publish_diagnostics_params params = {};
-    params.uri = sanitize_to_uri(file.path);
-    std::set<uint64_t> additional_files{};
-    for (const auto &diagnostic: file_diagnostics) {
-        if (diagnostic.file_fk != file.id_pk) {
-            additional_files.insert(diagnostic.file_fk);
-            continue;
+void sqfvm::language_server::language_server::queue_diagnostics(uint64_t file_id) {
+    std::lock_guard<std::mutex> lock(m_diagnostics_mutex);
+    m_queued_diagnostics.insert(file_id);
+}
+
+void sqfvm::language_server::language_server::publish_queued_diagnostics() {
+    std::set<uint64_t> file_ids;
+    {
+        std::lock_guard<std::mutex> lock(m_diagnostics_mutex);
+        file_ids.swap(m_queued_diagnostics);
+    }
+    for (auto file_id: file_ids) {
+        try {
+            lsp::data::publish_diagnostics_params params = {};
+            for (const auto &diagnostic: m_symbol_index.diagnostics_in(file_id)) {
+                lsp::data::diagnostics diag = {};
+                diag.code = diagnostic.code;
+                diag.message = diagnostic.message;
+                diag.range.start.line = diagnostic.line;
+                diag.range.start.character = diagnostic.column;
+                diag.range.end.line = diagnostic.line;
+                diag.range.end.character = diagnostic.column + diagnostic.length;
+                diag.severity = diagnostic.severity == database::tables::t_diagnostic::fatal
+                                ? lsp::data::diagnostic_severity::Error
+                                : diagnostic.severity == database::tables::t_diagnostic::error
+                                  ? lsp::data::diagnostic_severity::Error
+                                  : diagnostic.severity == database::tables::t_diagnostic::warning
+                                    ? lsp::data::diagnostic_severity::Warning
+                                    : diagnostic.severity == database::tables::t_diagnostic::info
+                                      ? lsp::data::diagnostic_severity::Information
+                                      : lsp::data::diagnostic_severity::Hint;
+                params.diagnostics.push_back(diag);
+            }
+            std::sort(params.diagnostics.begin(), params.diagnostics.end(), [](auto &l, auto &r) {
+                return std::tie(l.range.start.line, l.range.start.character, l.message)
+                       < std::tie(r.range.start.line, r.range.start.character, r.message);
+            });
+            auto json = params.to_json();
+            auto diagnostics_json = json["diagnostics"].dump();
+            auto fingerprint = std::hash<std::string>{}(diagnostics_json);
+
+            std::lock_guard<std::mutex> lock(m_diagnostics_mutex);
+            auto published_it = m_published_diagnostics.find(file_id);
+            if (published_it == m_published_diagnostics.end()) {
+                // The client starts out without any diagnostics
+                if (params.diagnostics.empty())
+                    continue;
+                auto path = m_symbol_index.file_path(file_id);
+                if (!path.has_value())
+                    continue;
+                published_it = m_published_diagnostics.emplace(
+                        file_id,
+                        published_diagnostics{
+                                .uri = sanitize_to_uri(path.value()),
+                                .fingerprint = 0,
+                                .json = {},
+                                .is_empty = true,
+                        }).first;
+            } else if (published_it->second.fingerprint == fingerprint
+                       && published_it->second.json == diagnostics_json) {
+                continue;
+            }
+            published_it->second.fingerprint = fingerprint;
+            published_it->second.json = std::move(diagnostics_json);
+            published_it->second.is_empty = params.diagnostics.empty();
+            params.uri = published_it->second.uri;
+            textDocument_publishDiagnostics(params);
+        }
+        catch (std::exception &e) {
+            window_log(::lsp::data::message_type::Error, [&](auto &sstream) {
+                sstream << "Failed to publish diagnostics for file with id " << file_id << ": " << e.what();
+            });
         }
-        lsp::data::diagnostics diag = {};
-        diag.code = diagnostic.code;
-        diag.message = diagnostic.message;
-        diag.range.start.line = diagnostic.line;
-        diag.range.start.character = diagnostic.column;
-        diag.range.end.line = diagnostic.line;
-        diag.range.end.character = diagnostic.column + diagnostic.length;
-        diag.severity = diagnostic.severity == database::tables::t_diagnostic::fatal
-                        ? lsp::data::diagnostic_severity::Error
-                        : diagnostic.severity == database::tables::t_diagnostic::error
-                          ? lsp::data::diagnostic_severity::Error
-                          : diagnostic.severity == database::tables::t_diagnostic::warning
-                            ? lsp::data::diagnostic_severity::Warning
-                            : diagnostic.severity == database::tables::t_diagnostic::info
-                              ? lsp::data::diagnostic_severity::Information
-                              : lsp::data::diagnostic_severity::Hint;
-        params.diagnostics.push_back(diag);
-    }
-    textDocument_publishDiagnostics(params);
-    if (!publish_sub_files)
-        return;
-    for (auto &additional_file_id: additional_files) {
-        auto additional_file = m_context->storage().get_optional<database::tables::t_file>(additional_file_id);
-        if (!additional_file.has_value())
-            continue;
-        publish_diagnostics(additional_file.value(), false);
     }
 }
 
@@ -474,8 +822,10 @@ void sqfvm::language_server::language_server::mark_all_files_as_outdated() {
 void sqfvm::language_server::language_server::file_system_item_removed(
         const std::filesystem::path &path,
         bool is_directory) {
-    if (is_subpath(path, m_lsp_folder.parent_path()))
+    if (is_subpath(path, m_lsp_folder.parent_path())) {
+        analysis::sqf_ast::visitors::scripted_visitor::invalidate(path);
         return;
+    }
     std::lock_guard<std::mutex> lock(m_analyze_mutex);
     if (is_directory) {
         auto files = m_context->storage().get_all<database::tables::t_file>(
@@ -497,8 +847,10 @@ void sqfvm::language_server::language_server::file_system_item_removed(
 void sqfvm::language_server::language_server::file_system_item_added(
         const std::filesystem::path &path,
         bool is_directory) {
-    if (is_subpath(path, m_lsp_folder.parent_path()))
+    if (is_subpath(path, m_lsp_folder.parent_path())) {
+        analysis::sqf_ast::visitors::scripted_visitor::invalidate(path);
         return;
+    }
     std::lock_guard<std::mutex> lock(m_analyze_mutex);
     if (is_directory) {
         for (auto &p: std::filesystem::recursive_directory_iterator(path)) {
@@ -521,8 +873,10 @@ void sqfvm::language_server::language_server::file_system_item_modified(
         bool is_directory) {
     if (is_directory)
         return;
-    if (is_subpath(path, m_lsp_folder.parent_path()))
+    if (is_subpath(path, m_lsp_folder.parent_path())) {
+        analysis::sqf_ast::visitors::scripted_visitor::invalidate(path);
         return;
+    }
     std::lock_guard<std::mutex> lock(m_analyze_mutex);
     if (iequal(path.filename().string(), "$PBOPREFIX$")) {
         add_or_update_pboprefix_mapping_logging(path);
@@ -3,11 +3,16 @@
 #include "analysis/sqf_ast/sqf_ast_analyzer.hpp"
 
 
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <limits>
 #include <string_view>
 #include <fstream>
 #include <utility>
 #include <vector>
 #include <set>
+#include <unordered_set>
 #include <sstream>
 #if defined(__GNUC__)
 #include <date/tz.h>
@@ -48,12 +53,27 @@ void sqfvm::language_server::language_server::after_initialize(const ::lsp::data
     }
 
     log_sqlite_migration_report();
+    // Converting rewrites the whole database, hence it is done here rather than in the maintenance of on_idle
+    auto [vacuum_success, converted] = database::context::operations::enable_incremental_vacuum(
+            *m_context, context_err_log());
+    if (vacuum_success && converted)
+        window_logMessage(::lsp::data::message_type::Log, "Converted SQLite3 database to incremental vacuum.");
+    log_database_statistics();
+
+    try {
+        m_symbol_index.load(*m_context);
+    } catch (const std::exception &e) {
+        window_log(::lsp::data::message_type::Error, [&](auto &sstream) {
+            sstream << "Failed to load symbol index from '" << m_db_path << "': " << e.what();
+        });
+    }
 
     // Mark all files as deleted, so we can remove them later if they are not in the workspace anymore
     if (!database::context::operations::mark_all_files_as_deleted(*m_context, context_err_log()))
         return;
 
     auto runtime = m_sqfvm_factory.create([](auto &_) {}, *m_context, std::make_shared<analysis::slspp_context>());
+    load_operator_completions(*runtime);
 
     // Mark all files according to their state (deleted, outdated)
     for (auto &workspace_folder: params.workspace_folders.value()) {
@@ -110,14 +130,10 @@ void sqfvm::language_server::language_server::after_initialize(const ::lsp::data
     }
     debug_print_sqfvm_vpath_start_parameters();
 
-    if (!database::context::operations::for_each_file_not_outdated(
-            *m_context,
-            context_err_log(),
-            [&](auto &file) {
-                publish_diagnostics(file);
-                return false;
-            }))
-        return;
+    // Publishes the diagnostics of all files that are up to date together with the ones analyzed below
+    for (auto file_id: m_symbol_index.file_ids()) {
+        queue_diagnostics(file_id);
+    }
 
     analyze_outdated_files();
 
@@ -160,51 +176,170 @@ std::optional<std::vector<lsp::data::location>> sqfvm::language_server::language
     auto [op_success1, file] = database::context::operations::find_file_by_path(*m_context, context_err_log(), path);
     if (!op_success1 || !file.has_value())
         return std::nullopt;
-    auto [op_success2, references] = database::context::operations::find_all_references_by_file_and_line(
-            *m_context,
-            context_err_log(),
-            file.value(),
+    auto reference = m_symbol_index.reference_at(
+            file->id_pk,
             params.position.line + 1,
+            params.position.character + 1,
             true);
-    if (!op_success2 || references.empty())
+    if (!reference.has_value())
         return std::nullopt;
-    std::optional<uint64_t> variable_id_opt;
-    for (auto &reference: references) {
-        if (reference.column >= params.position.character + 1 ||
-            reference.column + reference.length <= params.position.character + 1)
+    auto variable_references = m_symbol_index.references_of_variable(reference->variable_fk);
+    if (variable_references.empty())
+        return std::nullopt;
+    std::vector<lsp::data::location> locations;
+    locations.reserve(variable_references.size());
+    for (const auto &variable_reference: variable_references) {
+        auto file_uri = file_uri_of(variable_reference.file_fk);
+        if (!file_uri.has_value())
             continue;
-        variable_id_opt = reference.variable_fk;
-        break;
+        locations.emplace_back(lsp::data::location{
+                .uri = std::move(file_uri.value()),
+                .range = lsp::data::range{
+                        .start = lsp::data::position{
+                                .line = variable_reference.line - 1,
+                                .character = variable_reference.column
+                        },
+                        .end = lsp::data::position{
+                                .line = variable_reference.line - 1,
+                                .character = variable_reference.column + variable_reference.length
+                        }
+                },
+        });
     }
-    if (!variable_id_opt.has_value())
+    return {locations};
+}
+
+namespace {
+    // Returns the single edit turning previous into current, covering everything between their common prefix and suffix.
+    lsp::data::semantic_tokens_delta::semantic_tokens_edit semantic_tokens_edit_between(
+            const std::vector<uint32_t> &previous,
+            const std::vector<uint32_t> &current) {
+        auto shorter = std::min(previous.size(), current.size());
+        size_t prefix = 0;
+        while (prefix < shorter && previous[prefix] == current[prefix])
+            prefix++;
+        size_t suffix = 0;
+        while (suffix < shorter - prefix
+               && previous[previous.size() - 1 - suffix] == current[current.size() - 1 - suffix])
+            suffix++;
+        return {
+                .start = static_cast<uint32_t>(prefix),
+                .deleteCount = static_cast<uint32_t>(previous.size() - prefix - suffix),
+                .data = std::vector<uint32_t>(
+                        current.begin() + static_cast<ptrdiff_t>(prefix),
+                        current.end() - static_cast<ptrdiff_t>(suffix)),
+        };
+    }
+}
+
+std::optional<std::reference_wrapper<sqfvm::language_server::language_server::semantic_tokens_cache_entry>>
+sqfvm::language_server::language_server::semantic_tokens_of(const ::lsp::data::text_document_identifier &text_document) {
+    auto path = std::filesystem::path(
+            std::string(text_document.uri.path().begin(),
+                        text_document.uri.path().end()))
+            .lexically_normal();
+    auto file_opt = get_file_from_path(path.string(), false);
+    if (!file_opt.has_value())
         return std::nullopt;
-    auto variable_id = variable_id_opt.value();
-    auto [op_success3, variable_references] = database::context::operations::get_all_variables_of_variable(
-            *m_context,
-            context_err_log(),
-            variable_id);
-    if (!op_success3 || variable_references.empty())
+    auto document_uri = static_cast<::lsp::data::document_uri>(text_document.uri.full());
+    auto version = m_versions.contains(document_uri)
+                   ? std::optional<::lsp::data::integer>{m_versions.at(document_uri)}
+                   : std::nullopt;
+    auto generation = m_symbol_index.generation_of(file_opt->id_pk);
+    auto &cache = m_semantic_tokens_cache[file_opt->id_pk];
+    if (!cache.result_id.empty() && cache.version == version && cache.generation == generation)
+        return cache;
+    auto data = m_symbol_index.semantic_tokens_of(file_opt->id_pk);
+    // An unchanged array keeps its result id, so the client is not sent an empty delta under a new one
+    if (cache.result_id.empty() || data != cache.data) {
+        cache.previous_result_id = std::move(cache.result_id);
+        cache.previous_data = std::move(cache.data);
+        cache.result_id = std::to_string(++m_semantic_tokens_result_id);
+        cache.data = std::move(data);
+    }
+    cache.version = version;
+    cache.generation = generation;
+    return cache;
+}
+
+std::optional<lsp::data::semantic_tokens> sqfvm::language_server::language_server::on_textDocument_semanticTokens_full(
+        const lsp::data::semantic_tokens_params &params) {
+    auto cache = semantic_tokens_of(params.textDocument);
+    if (!cache.has_value())
         return std::nullopt;
+    return lsp::data::semantic_tokens{
+            .resultId = cache->get().result_id,
+            .data = cache->get().data,
+    };
+}
+
+std::optional<std::variant<lsp::data::semantic_tokens, lsp::data::semantic_tokens_delta>>
+sqfvm::language_server::language_server::on_textDocument_semanticTokens_full_delta(
+        const lsp::data::semantic_tokens_delta_params &params) {
+    using namespace ::lsp::data;
+    auto cache_opt = semantic_tokens_of(params.textDocument);
+    if (!cache_opt.has_value())
+        return std::nullopt;
+    const auto &cache = cache_opt->get();
+    if (params.previousResultId == cache.result_id)
+        return semantic_tokens_delta{.resultId = cache.result_id, .edits = {}};
+    if (params.previousResultId == cache.previous_result_id)
+        return semantic_tokens_delta{
+                .resultId = cache.result_id,
+                .edits = {semantic_tokens_edit_between(cache.previous_data, cache.data)},
+        };
+    // The client holds a result no longer known, hence it receives the full array again
+    return semantic_tokens{.resultId = cache.result_id, .data = cache.data};
+}
+
+std::optional<std::vector<::lsp::data::location>> sqfvm::language_server::language_server::declarations_at(
+        const ::lsp::data::text_document_identifier &text_document,
+        const ::lsp::data::position &position) {
+    auto path = std::filesystem::path(
+            std::string(text_document.uri.path().begin(),
+                        text_document.uri.path().end()))
+            .lexically_normal();
+    auto file_opt = get_file_from_path(path.string(), false);
+    if (!file_opt.has_value())
+        return std::nullopt;
+    auto reference = m_symbol_index.reference_at(
+            file_opt->id_pk,
+            position.line + 1,
+            position.character + 1,
+            true);
+    if (!reference.has_value())
+        return config_base_declarations_at(file_opt->id_pk, position);
     std::vector<lsp::data::location> locations;
-    for (const auto &reference: variable_references) {
-        auto [op_success4, file_opt] = database::context::operations::find_file_by_id(
+    // Globals compiled from CfgFunctions are never assigned, hence their function file is their declaration
+    auto variable = m_symbol_index.variable(reference->variable_fk);
+    if (variable.has_value() && !variable->opt_scope_fk.has_value()) {
+        auto [success, functions] = database::context::operations::find_config_functions_by_name(
                 *m_context,
                 context_err_log(),
-                reference.file_fk);
-        if (!op_success4 || !file_opt.has_value())
+                variable->variable_name);
+        for (const auto &function: functions) {
+            auto function_locations = config_function_locations_of(function);
+            std::move(function_locations.begin(), function_locations.end(), std::back_inserter(locations));
+        }
+    }
+    auto declarations = m_symbol_index.declarations_of_variable(reference->variable_fk, file_opt->id_pk);
+    if (declarations.empty() && locations.empty())
+        return std::nullopt;
+    locations.reserve(locations.size() + declarations.size());
+    for (const auto &declaration: declarations) {
+        auto file_uri = file_uri_of(declaration.file_fk);
+        if (!file_uri.has_value())
             continue;
-        auto file_path = file_opt->path;
-        lsp::data::uri file_uri("file:///" + file_path);
         locations.emplace_back(lsp::data::location{
-                .uri = file_uri,
+                .uri = std::move(file_uri.value()),
                 .range = lsp::data::range{
                         .start = lsp::data::position{
-                                .line = reference.line - 1,
-                                .character = reference.column
+                                .line = declaration.line - 1,
+                                .character = declaration.column
                         },
                         .end = lsp::data::position{
-                                .line = reference.line - 1,
-                                .character = reference.column + reference.length
+                                .line = declaration.line - 1,
+                                .character = declaration.column + declaration.length
                         }
                 },
         });
@@ -212,15 +347,207 @@ std::optional<std::vector<lsp::data::location>> sqfvm::language_server::language
     return {locations};
 }
 
+std::optional<std::vector<::lsp::data::location>> sqfvm::language_server::language_server::config_base_declarations_at(
+        uint64_t file_id,
+        const ::lsp::data::position &position) {
+    auto [success, config_classes] = database::context::operations::find_config_classes_by_file_and_base_line(
+            *m_context,
+            context_err_log(),
+            file_id,
+            position.line + 1);
+    if (!success)
+        return std::nullopt;
+    auto config_class = std::find_if(config_classes.begin(), config_classes.end(), [&](const auto &it) {
+        return it.base_column <= position.character
+               && position.character <= it.base_column + it.base_name.length();
+    });
+    if (config_class == config_classes.end() || !config_class->opt_base_path.has_value())
+        return std::nullopt;
+    auto [bases_success, bases] = database::context::operations::find_config_classes_by_path(
+            *m_context,
+            context_err_log(),
+            config_class->opt_base_path.value());
+    if (!bases_success || bases.empty())
+        return std::nullopt;
+    std::vector<lsp::data::location> locations;
+    locations.reserve(bases.size());
+    for (const auto &base: bases) {
+        auto file_uri = file_uri_of(base.file_fk);
+        if (!file_uri.has_value())
+            continue;
+        locations.emplace_back(lsp::data::location{
+                .uri = std::move(file_uri.value()),
+                .range = lsp::data::range{
+                        .start = lsp::data::position{
+                                .line = base.line - 1,
+                                .character = base.column
+                        },
+                        .end = lsp::data::position{
+                                .line = base.line - 1,
+                                .character = base.column + base.name.length()
+                        }
+                },
+        });
+    }
+    return {locations};
+}
+
+std::vector<::lsp::data::location> sqfvm::language_server::language_server::config_function_locations_of(
+        const database::tables::t_config_function &function) {
+    std::vector<lsp::data::location> locations;
+    if (function.opt_target_file_fk.has_value()) {
+        // Files without any analysis results are not indexed, yet their path is known from the function
+        auto file_uri = file_uri_of(function.opt_target_file_fk.value());
+        locations.emplace_back(lsp::data::location{
+                .uri = file_uri.has_value() ? std::move(file_uri.value()) : sanitize_to_uri(function.path),
+                .range = lsp::data::range{
+                        .start = lsp::data::position{.line = 0, .character = 0},
+                        .end = lsp::data::position{.line = 0, .character = 0}
+                },
+        });
+    }
+    auto file_uri = file_uri_of(function.file_fk);
+    if (file_uri.has_value()) {
+        locations.emplace_back(lsp::data::location{
+                .uri = std::move(file_uri.value()),
+                .range = lsp::data::range{
+                        .start = lsp::data::position{
+                                .line = function.line - 1,
+                                .character = function.column
+                        },
+                        .end = lsp::data::position{
+                                .line = function.line - 1,
+                                .character = function.column
+                        }
+                },
+        });
+    }
+    return locations;
+}
+
+std::optional<std::vector<lsp::data::location>> sqfvm::language_server::language_server::on_textDocument_definition(
+        const lsp::data::definition_params &params) {
+    return declarations_at(params.textDocument, params.position);
+}
+
+std::optional<std::vector<lsp::data::location>> sqfvm::language_server::language_server::on_textDocument_declaration(
+        const lsp::data::declaration_params &params) {
+    return declarations_at(params.textDocument, params.position);
+}
+
+std::optional<::lsp::data::symbol_information> sqfvm::language_server::language_server::symbol_information_of(
+        const database::symbol_index::declaration_result &declaration) {
+    using namespace ::lsp::data;
+    const auto &[variable, reference] = declaration;
+    auto file_uri = file_uri_of(reference.file_fk);
+    if (!file_uri.has_value())
+        return std::nullopt;
+    auto is_code = (reference.types & database::tables::t_reference::type_flags::code)
+                   == database::tables::t_reference::type_flags::code;
+    return symbol_information{
+            .name = variable.variable_name,
+            .kind = is_code ? symbol_kind::Function : symbol_kind::Variable,
+            .location = location{
+                    .uri = std::move(file_uri.value()),
+                    .range = range{
+                            .start = position{
+                                    .line = reference.line - 1,
+                                    .character = reference.column
+                            },
+                            .end = position{
+                                    .line = reference.line - 1,
+                                    .character = reference.column + reference.length
+                            }
+                    },
+            },
+            .containerName = variable.opt_scope_fk.has_value()
+                             ? std::nullopt
+                             : std::optional<std::string>(variable.scope),
+    };
+}
+
+std::optional<std::vector<lsp::data::symbol_information>>
+sqfvm::language_server::language_server::on_textDocument_documentSymbol(
+        const lsp::data::document_symbol_params &params) {
+    auto path = std::filesystem::path(
+            std::string(params.textDocument.uri.path().begin(),
+                        params.textDocument.uri.path().end()))
+            .lexically_normal();
+    auto file_opt = get_file_from_path(path.string(), false);
+    if (!file_opt.has_value())
+        return std::nullopt;
+    std::vector<lsp::data::symbol_information> symbols;
+    for (const auto &declaration: m_symbol_index.declarations_in(file_opt->id_pk)) {
+        auto symbol = symbol_information_of(declaration);
+        if (symbol.has_value())
+            symbols.push_back(std::move(symbol.value()));
+    }
+    return {symbols};
+}
+
+std::optional<std::vector<lsp::data::symbol_information>>
+sqfvm::language_server::language_server::on_workspace_symbol(const lsp::data::workspace_symbol_params &params) {
+    std::vector<lsp::data::symbol_information> symbols;
+    std::unordered_set<std::string> names;
+    for (const auto &declaration: m_symbol_index.search_global_declarations(params.query, workspace_symbol_limit)) {
+        auto symbol = symbol_information_of(declaration);
+        if (!symbol.has_value())
+            continue;
+        names.insert(database::symbol_index::fold_case(symbol->name));
+        symbols.push_back(std::move(symbol.value()));
+    }
+    if (symbols.size() >= workspace_symbol_limit)
+        return {symbols};
+
+    // Functions of CfgFunctions usually are never assigned in SQF, hence they are looked up separately
+    for (const auto &function: m_symbol_index.search_functions(params.query, workspace_symbol_limit - symbols.size())) {
+        if (!names.insert(database::symbol_index::fold_case(function.name)).second)
+            continue;
+        auto locations = config_function_locations_of(function);
+        if (locations.empty())
+            continue;
+        symbols.push_back(lsp::data::symbol_information{
+                .name = function.name,
+                .kind = lsp::data::symbol_kind::Function,
+                .location = std::move(locations.front()),
+                .containerName = "CfgFunctions",
+        });
+    }
+    return {symbols};
+}
+
+std::optional<::lsp::data::uri> sqfvm::language_server::language_server::file_uri_of(uint64_t file_id) {
+    auto path = m_symbol_index.file_path(file_id);
+    auto uri_it = m_file_uris.find(file_id);
+    if (!path.has_value()) {
+        // Files without any rows in the symbol index (e.g. configs only declaring classes) are looked up
+        // in the database instead, their path never changes
+        if (uri_it != m_file_uris.end())
+            return uri_it->second.second;
+        auto file = m_context->storage().get_pointer<database::tables::t_file>(file_id);
+        if (!file)
+            return std::nullopt;
+        path = file->path;
+    }
+    if (uri_it == m_file_uris.end() || uri_it->second.first != path.value())
+        uri_it = m_file_uris.insert_or_assign(file_id, std::make_pair(path.value(), sanitize_to_uri(path.value()))).first;
+    return uri_it->second.second;
+}
+
 void sqfvm::language_server::language_server::on_textDocument_didOpen(
         const lsp::data::did_open_text_document_params &params) {
-    m_versions[static_cast<::lsp::data::document_uri>(params.text_document.uri.full())] = params.text_document.version;
+    auto document_uri = static_cast<::lsp::data::document_uri>(params.text_document.uri.full());
+    m_versions[document_uri] = params.text_document.version;
+    m_document_contents[document_uri] = params.text_document.text;
 }
 
 void sqfvm::language_server::language_server::on_textDocument_didChange(
         const ::lsp::data::did_change_text_document_params &params) {
     std::lock_guard<std::mutex> lock(m_analyze_mutex);
-    m_versions[static_cast<::lsp::data::document_uri>(params.text_document.uri.full())] = params.text_document.version;
+    auto document_uri = static_cast<::lsp::data::document_uri>(params.text_document.uri.full());
+    m_versions[document_uri] = params.text_document.version;
+    if (!params.content_changes.empty())
+        m_document_contents[document_uri] = params.content_changes[0].text;
     auto path = std::filesystem::path(
             std::string(params.text_document.uri.path().begin(),
                         params.text_document.uri.path().end()))
@@ -251,12 +578,186 @@ void sqfvm::language_server::language_server::on_textDocument_didChange(
 std::optional<std::vector<::lsp::data::folding_range>>
 sqfvm::language_server::language_server::on_textDocument_foldingRange(
         const ::lsp::data::folding_range_params &params) {
-    return {};
+    using namespace ::lsp::data;
+    auto path = std::filesystem::path(
+            std::string(params.textDocument.uri.path().begin(),
+                        params.textDocument.uri.path().end()))
+            .lexically_normal();
+    auto file_opt = get_file_from_path(path.string(), false);
+    if (!file_opt.has_value())
+        return std::nullopt;
+    auto file = file_opt.value();
+    std::vector<folding_range> result;
+    for (const auto &it: m_symbol_index.folding_ranges_in(file.id_pk)) {
+        result.push_back(folding_range{
+                .startLine = it.start_line,
+                .endLine = it.end_line,
+                .kind = it.kind == database::tables::t_folding_range::preprocessor
+                        ? std::optional<folding_range_kind>(folding_range_kind::Region)
+                        : std::nullopt,
+        });
+    }
+    return result;
+}
+
+void sqfvm::language_server::language_server::on_textDocument_didClose(
+        const ::lsp::data::did_close_text_document_params &params) {
+    auto document_uri = static_cast<::lsp::data::document_uri>(params.text_document.uri.full());
+    m_document_contents.erase(document_uri);
+    m_versions.erase(document_uri);
+    forget_deleted_files();
+    auto path = std::filesystem::path(
+            std::string(params.text_document.uri.path().begin(),
+                        params.text_document.uri.path().end()))
+            .lexically_normal();
+    auto file_opt = get_file_from_path(path.string(), false);
+    if (!file_opt.has_value())
+        return;
+    forget_cached_file(file_opt->id_pk);
+    std::lock_guard<std::mutex> lock(m_diagnostics_mutex);
+    auto published_it = m_published_diagnostics.find(file_opt->id_pk);
+    // Diagnostics of closed files stay visible in the client, the entry is still needed to clear them later
+    if (published_it != m_published_diagnostics.end() && published_it->second.is_empty)
+        m_published_diagnostics.erase(published_it);
+}
+
+namespace {
+    // Returns the inlay hint label of the given types, or an empty string if no hint should be shown.
+    std::string type_label(sqfvm::language_server::database::tables::t_reference::type_flags types) {
+        using type_flags = sqfvm::language_server::database::tables::t_reference::type_flags;
+        // ToDo: Track this properly, allowing for not always having "any" as type
+        if (types == type_flags::none || types == type_flags::all || types == type_flags::any)
+            return {};
+        static const std::pair<type_flags, std::string_view> names[] = {
+                {type_flags::code,    "code"},
+                {type_flags::scalar,  "scalar"},
+                {type_flags::boolean, "boolean"},
+                {type_flags::object,  "object"},
+                {type_flags::hashmap, "hashmap"},
+                {type_flags::array,   "array"},
+                {type_flags::string,  "string"},
+                {type_flags::nil,     "nil"},
+        };
+        std::string label = ": ";
+        for (const auto &[flag, name]: names) {
+            if ((types & flag) != flag)
+                continue;
+            if (label.size() > 2)
+                label.append(", ");
+            label.append(name);
+        }
+        return label;
+    }
+
+    // Returns the identifier characters directly in front of the given 0-based position.
+    std::string_view word_before(std::string_view contents, uint64_t line, uint64_t character) {
+        size_t line_start = 0;
+        for (uint64_t i = 0; i < line; i++) {
+            line_start = contents.find('\n', line_start);
+            if (line_start == std::string_view::npos)
+                return {};
+            line_start++;
+        }
+        auto line_end = contents.find('\n', line_start);
+        auto end = std::min<size_t>(
+                line_start + character,
+                line_end == std::string_view::npos ? contents.size() : line_end);
+        auto start = end;
+        while (start > line_start) {
+            auto c = static_cast<unsigned char>(contents[start - 1]);
+            if (!std::isalnum(c) && c != '_')
+                break;
+            start--;
+        }
+        return contents.substr(start, end - start);
+    }
 }
 
 std::optional<::lsp::data::completion_list> sqfvm::language_server::language_server::on_textDocument_completion(
         const ::lsp::data::completion_params &params) {
-    return {};
+    using namespace ::lsp::data;
+    auto path = std::filesystem::path(
+            std::string(params.textDocument.uri.path().begin(),
+                        params.textDocument.uri.path().end()))
+            .lexically_normal();
+    auto file_opt = get_file_from_path(path.string(), false);
+    if (!file_opt.has_value())
+        return std::nullopt;
+    auto file = file_opt.value();
+    auto contents_it = m_document_contents.find(
+            static_cast<::lsp::data::document_uri>(params.textDocument.uri.full()));
+    auto prefix = contents_it == m_document_contents.end()
+                  ? std::string_view{}
+                  : word_before(contents_it->second, params.position.line, params.position.character);
+
+    completion_list result{.isIncomplete = false, .items = {}};
+    std::unordered_set<std::string> names;
+    // Ranked by locality: privates in reach, workspace globals, then operators
+    auto add = [&](std::string label, completion_item_kind kind, std::string_view rank, nlohmann::json data) {
+        if (result.items.size() >= completion_item_limit) {
+            result.isIncomplete = true;
+            return;
+        }
+        if (!names.insert(database::symbol_index::fold_case(label)).second)
+            return;
+        auto sort_text = std::string(rank) + label;
+        result.items.push_back(completion_item{
+                .label = std::move(label),
+                .kind = static_cast<size_t>(kind),
+                .sort_text = std::move(sort_text),
+                .data = std::move(data),
+        });
+    };
+    for (const auto &variable: m_symbol_index.privates_before(
+            file.id_pk,
+            params.position.line + 1,
+            params.position.character + 1,
+            prefix)) {
+        add(variable.variable_name, completion_item_kind::Variable, "0", {{"variableId", variable.id_pk}});
+    }
+    for (const auto &variable: m_symbol_index.globals_with_prefix("missionNamespace", prefix, completion_item_limit)) {
+        add(variable.variable_name, completion_item_kind::Variable, "1", {{"variableId", variable.id_pk}});
+    }
+    auto folded_prefix = database::symbol_index::fold_case(prefix);
+    for (auto it = std::lower_bound(
+            m_operator_completions.begin(),
+            m_operator_completions.end(),
+            folded_prefix,
+            [](const operator_completion &l, const std::string &r) { return l.folded_name < r; });
+         it != m_operator_completions.end() && it->folded_name.starts_with(folded_prefix) && !result.isIncomplete;
+         ++it) {
+        add(it->name, completion_item_kind::Function, "2", {{"operator", it->folded_name}});
+    }
+    return result;
+}
+
+::lsp::data::completion_item sqfvm::language_server::language_server::on_completionItem_resolve(
+        const ::lsp::data::completion_item &params) {
+    using namespace ::lsp::data;
+    auto result = params;
+    if (!params.data.has_value() || !params.data->is_object())
+        return result;
+    if (params.data->contains("operator")) {
+        auto name = params.data->at("operator").get<std::string>();
+        auto it = std::lower_bound(
+                m_operator_completions.begin(),
+                m_operator_completions.end(),
+                name,
+                [](const operator_completion &l, const std::string &r) { return l.folded_name < r; });
+        if (it != m_operator_completions.end() && it->folded_name == name && !it->description.empty())
+            result.documentation = markup_content{markup_kind::Markdown, it->description};
+    } else if (params.data->contains("variableId")) {
+        auto variable = m_symbol_index.variable(params.data->at("variableId").get<uint64_t>());
+        if (!variable.has_value())
+            return result;
+        if (variable->opt_scope_fk.has_value()) {
+            auto label = type_label(variable->types);
+            result.detail = "private" + label;
+        } else {
+            result.detail = variable->scope;
+        }
+    }
+    return result;
 }
 
 ::lsp::data::initialize_result sqfvm::language_server::language_server::on_initialize(
@@ -272,11 +773,13 @@ std::optional<::lsp::data::completion_list> sqfvm::language_server::language_ser
     res.capabilities.textDocumentSync->save = ::lsp::data::initialize_result::server_capabilities::text_document_sync_options::SaveOptions{};
     res.capabilities.textDocumentSync->save->includeText = true;
     res.capabilities.textDocumentSync->willSave = false;
-    // res.capabilities.foldingRangeProvider = ::lsp::data::initialize_result::server_capabilities::folding_range_registration_options{};
-    // res.capabilities.foldingRangeProvider->documentSelector = ::lsp::data::document_filter{};
-    // res.capabilities.foldingRangeProvider->documentSelector->language = "sqf";
+    res.capabilities.foldingRangeProvider = ::lsp::data::initialize_result::server_capabilities::folding_range_registration_options{.workDoneProgress = false};
     res.capabilities.completionProvider = lsp::data::initialize_result::server_capabilities::completion_options{.resolveProvider = true};
     res.capabilities.referencesProvider = lsp::data::initialize_result::server_capabilities::reference_options{.workDoneProgress = false};
+    res.capabilities.definitionProvider = lsp::data::initialize_result::server_capabilities::definition_options{.workDoneProgress = false};
+    res.capabilities.declarationProvider = lsp::data::initialize_result::server_capabilities::declaration_registration_options{.workDoneProgress = false};
+    res.capabilities.documentSymbolProvider = lsp::data::initialize_result::server_capabilities::document_symbol_options{.workDoneProgress = false};
+    res.capabilities.workspaceSymbolProvider = true;
     res.capabilities.codeActionProvider = lsp::data::initialize_result::server_capabilities::code_action_options{
             .codeActionKinds = {std::vector<lsp::data::code_action_kind>{
                     lsp::data::code_action_kind::QuickFix,
@@ -285,10 +788,21 @@ std::optional<::lsp::data::completion_list> sqfvm::language_server::language_ser
                     lsp::data::code_action_kind::RefactorInline,
                     lsp::data::code_action_kind::Source,
                     lsp::data::code_action_kind::RefactorRewrite,
-            }}
+            }},
+            .resolveProvider = true,
     };
     res.capabilities.hoverProvider = lsp::data::initialize_result::server_capabilities::hover_options{.workDoneProgress = false};
     res.capabilities.inlayHintProvider = lsp::data::initialize_result::server_capabilities::inlay_hint_options{.work_done_progress = false, .resolve_provider = true};
+    // Has to match the order of database::symbol_index::semantic_token_type and semantic_token_modifier
+    res.capabilities.semanticTokensProvider = lsp::data::initialize_result::server_capabilities::semantic_tokens_options{
+            .workDoneProgress = false,
+            .legend = {
+                    .tokenTypes = {"variable", "function"},
+                    .tokenModifiers = {"declaration", "private", "global", "magic", "undefined"},
+            },
+            .range = false,
+            .full = lsp::data::initialize_result::server_capabilities::semantic_tokens_options::semantic_tokens_full_options{.delta = true},
+    };
 
     return res;
 }
@@ -296,7 +810,6 @@ std::optional<::lsp::data::completion_list> sqfvm::language_server::language_ser
 
 std::optional<std::vector<lsp::data::inlay_hint>>
 sqfvm::language_server::language_server::on_textDocument_inlayHint(const lsp::data::inlay_hint_params &params) {
-    using database::tables::t_reference;
     auto line_start = params.range.start.line + 1;
     auto line_end = params.range.end.line + 1;
     auto column_start = params.range.start.character;
@@ -309,106 +822,77 @@ sqfvm::language_server::language_server::on_textDocument_inlayHint(const lsp::da
     if (!file_opt.has_value())
         return std::nullopt;
     auto file = file_opt.value();
-    auto references_in_range = m_context->storage().get_all<database::tables::t_reference>(
-            where(c(&database::tables::t_reference::file_fk) == file.id_pk
-                  and c(&database::tables::t_reference::line) >= line_start
-                  and c(&database::tables::t_reference::line) <= line_end
-                  and (c(&database::tables::t_reference::line) != line_start
-                       or c(&database::tables::t_reference::column) >= column_start)
-                  and (c(&database::tables::t_reference::line) != line_end
-                       or c(&database::tables::t_reference::column) <= column_end)));
-    std::unordered_map<uint64_t, std::vector<database::tables::t_reference>> variable_map{};
-    for (auto &reference: references_in_range) {
-        if (reference.is_magic_variable)
-            continue;
-        variable_map[reference.variable_fk].push_back(reference);
-    }
-    std::unordered_map<uint64_t, std::string> variable_types_string{};
-    std::stringstream sstream;
-    for (auto &[variable_id, references]: variable_map) {
-        sstream.str("");
-        sstream << ": ";
-        auto variable = m_context->storage().get<database::tables::t_variable>(variable_id);
-        if (!variable.opt_file_fk.has_value()) {
-            sstream << "ERROR";
-        } else {
-            t_reference::type_flags final_type = t_reference::type_flags::none;
-            for (auto &reference: references) {
-                if (final_type == t_reference::type_flags::any || final_type == t_reference::type_flags::all) {
-                    break;
-                }
-                final_type = final_type | reference.types;
-            }
-            if (final_type == t_reference::type_flags::none
-                || final_type == t_reference::type_flags::all
-                || final_type == t_reference::type_flags::any) {
-                // ToDo: Track this properly, allowing for not always having "any" as type
-                continue; // Skip for now to prevent any from being reported
-                sstream << "any";
-            } else {
-                bool flag = false;
-                if ((final_type & t_reference::type_flags::code) == t_reference::type_flags::code) {
-                    sstream << (!flag ? "code" : ", code");
-                    flag = true;
-                }
-                if ((final_type & t_reference::type_flags::scalar) == t_reference::type_flags::scalar) {
-                    sstream << (!flag ? "scalar" : ", scalar");
-                    flag = true;
-                }
-                if ((final_type & t_reference::type_flags::boolean) == t_reference::type_flags::boolean) {
-                    sstream << (!flag ? "boolean" : ", boolean");
-                    flag = true;
-                }
-                if ((final_type & t_reference::type_flags::object) == t_reference::type_flags::object) {
-                    sstream << (!flag ? "object" : ", object");
-                    flag = true;
-                }
-                if ((final_type & t_reference::type_flags::hashmap) == t_reference::type_flags::hashmap) {
-                    sstream << (!flag ? "hashmap" : ", hashmap");
-                    flag = true;
-                }
-                if ((final_type & t_reference::type_flags::array) == t_reference::type_flags::array) {
-                    sstream << (!flag ? "array" : ", array");
-                    flag = true;
-                }
-                if ((final_type & t_reference::type_flags::string) == t_reference::type_flags::string) {
-                    sstream << (!flag ? "string" : ", string");
-                    flag = true;
-                }
-                if ((final_type & t_reference::type_flags::nil) == t_reference::type_flags::nil) {
-                    sstream << (!flag ? "nil" : ", nil");
-                    flag = true;
-                }
-            }
-        }
-        variable_types_string[variable_id] = sstream.str();
+
+    // Drop the cached hints if either the document or its analysis results changed
+    auto document_uri = static_cast<::lsp::data::document_uri>(params.text_document.uri.full());
+    auto version = m_versions.contains(document_uri)
+                   ? std::optional<::lsp::data::integer>{m_versions.at(document_uri)}
+                   : std::nullopt;
+    auto generation = m_symbol_index.generation_of(file.id_pk);
+    auto &cache = m_inlay_hint_cache[file.id_pk];
+    if (cache.version != version || cache.generation != generation) {
+        cache.version = version;
+        cache.generation = generation;
+        cache.buckets.clear();
     }
+
     std::vector<lsp::data::inlay_hint> hints{};
-    for (auto &[variable_id, references]: variable_map) {
-        auto variable = m_context->storage().get<database::tables::t_variable>(variable_id);
-        if (!variable.opt_file_fk.has_value())
-            continue;
-        auto variable_type = variable_types_string[variable_id];
-        for (auto &reference: references) {
-            if (line_start > reference.line || reference.line > line_end)
+    for (auto bucket = (line_start - 1) / inlay_hint_bucket_lines;
+         bucket <= (line_end - 1) / inlay_hint_bucket_lines;
+         bucket++) {
+        auto bucket_it = cache.buckets.find(bucket);
+        if (bucket_it == cache.buckets.end())
+            bucket_it = cache.buckets.emplace(bucket, compute_inlay_hints(file.id_pk, bucket)).first;
+        for (const auto &it: bucket_it->second) {
+            if (line_start > it.line || it.line > line_end)
                 continue;
-            if (line_start == reference.line && reference.column < column_start)
+            if (line_start == it.line && it.column < column_start)
                 continue;
-            if (line_end == reference.line && reference.column > column_end)
+            if (line_end == it.line && it.column > column_end)
                 continue;
+            hints.push_back(it.hint);
+        }
+    }
+    return hints;
+}
 
-            hints.push_back(lsp::data::inlay_hint{
-                    .position = lsp::data::position{
-                            .line = reference.line - 1,
-                            .character = reference.column + reference.length,
-                    },
-                    .label = {
-                            // lsp::data::inlay_hint_label_part{.value = variable.variable_name},
-                            lsp::data::inlay_hint_label_part{.value = variable_type}
-                    },
-                    .kind = lsp::data::inlay_hint_kind::Type,
-            });
+std::vector<sqfvm::language_server::language_server::cached_inlay_hint>
+sqfvm::language_server::language_server::compute_inlay_hints(uint64_t file_id, uint64_t bucket) {
+    std::vector<cached_inlay_hint> hints{};
+    auto references = m_symbol_index.references_in_range(
+            file_id,
+            bucket * inlay_hint_bucket_lines + 1,
+            0,
+            (bucket + 1) * inlay_hint_bucket_lines,
+            std::numeric_limits<uint64_t>::max());
+    std::unordered_map<uint64_t, std::string> labels{};
+    for (const auto &reference: references) {
+        if (reference.is_magic_variable)
+            continue;
+        auto label_it = labels.find(reference.variable_fk);
+        if (label_it == labels.end()) {
+            auto variable = m_symbol_index.variable(reference.variable_fk);
+            auto label = variable.has_value() && variable->opt_file_fk.has_value()
+                         ? type_label(variable->types)
+                         : std::string{};
+            label_it = labels.emplace(reference.variable_fk, std::move(label)).first;
         }
+        if (label_it->second.empty())
+            continue;
+        hints.push_back(cached_inlay_hint{
+                .line = reference.line,
+                .column = reference.column,
+                .hint = lsp::data::inlay_hint{
+                        .position = lsp::data::position{
+                                .line = reference.line - 1,
+                                .character = reference.column + reference.length,
+                        },
+                        .label = {
+                                lsp::data::inlay_hint_label_part{.value = label_it->second}
+                        },
+                        .kind = lsp::data::inlay_hint_kind::Type,
+                },
+        });
     }
     return hints;
 }
@@ -423,12 +907,105 @@ void sqfvm::language_server::language_server::debug_print_sqfvm_vpath_start_para
         }
     });
 }
+lsp::data::workspace_edit sqfvm::language_server::language_server::code_action_edit(
+        const std::vector<database::tables::t_code_action_change> &changes) {
+    using namespace lsp::data;
+    using namespace database::tables;
+    using namespace std::string_literals;
+    std::vector<std::variant<text_document_edit, create_file, rename_file, lsp::data::delete_file>> out_changes{};
+    for (const auto &change: changes) {
+        auto change_path = sanitize_to_uri(change.path);
+        auto document_uri = static_cast<::lsp::data::document_uri>(change_path.full());
+        auto lsp_file_version = m_versions.contains(document_uri)
+                                ? std::optional<::lsp::data::integer>{m_versions.at(document_uri)}
+                                : std::nullopt;
+        switch (change.operation) {
+            case t_code_action_change::file_change:
+                out_changes.emplace_back(text_document_edit{
+                        .textDocument = optional_versioned_text_document_identifier{
+                                .version = lsp_file_version,
+                                .uri = change_path,
+                        },
+                        .edits = {text_edit{
+                                .range = range{
+                                        .start = position{
+                                                .line = change.start_line.value_or(0),
+                                                .character = change.start_column.value_or(0),
+                                        },
+                                        .end = position{
+                                                .line = change.end_line.value_or(0),
+                                                .character = change.end_column.value_or(0),
+                                        },
+                                },
+                                .new_text = change.content.value_or(""s),
+                        }},
+                });
+                break;
+            case t_code_action_change::file_create:
+                out_changes.emplace_back(create_file{
+                        .uri = change_path,
+                        .options = create_file::create_file_options{
+                                .overwrite = true,
+                                .ignore_if_exists = true,
+                        },
+                });
+                out_changes.emplace_back(text_document_edit{
+                        .textDocument = optional_versioned_text_document_identifier{
+                                .version = lsp_file_version,
+                                .uri = change_path,
+                        },
+                        .edits = {text_edit{
+                                .range = range{
+                                        .start = position{0, 0},
+                                        .end = position{0, 0},
+                                },
+                                .new_text = change.content.value_or(""s),
+                        }},
+                });
+                break;
+            case t_code_action_change::file_delete:
+                out_changes.emplace_back(lsp::data::delete_file{
+                        .uri = change_path,
+                        .options = lsp::data::delete_file::delete_file_options{
+                                .recursive = true,
+                                .ignore_if_not_exists = true,
+                        },
+                });
+                break;
+            case t_code_action_change::file_rename:
+                out_changes.emplace_back(rename_file{
+                        .oldUri = sanitize_to_uri(change.old_path.value_or(""s)),
+                        .newUri = change_path,
+                        .options = rename_file::rename_file_options{
+                                .overwrite = true,
+                                .ignore_if_exists = true,
+                        },
+                });
+                break;
+        }
+    }
+    return workspace_edit{
+            .changes = {},
+            .document_changes = out_changes,
+            .change_annotations = {},
+    };
+}
+
+bool sqfvm::language_server::language_server::client_resolves_code_action_edits() const {
+    const auto &text_document = m_client_params.capabilities.textDocument;
+    if (!text_document.has_value() || !text_document->codeAction.has_value())
+        return false;
+    const auto &code_action = text_document->codeAction.value();
+    if (!code_action.dataSupport.value_or(false) || !code_action.resolveSupport.has_value())
+        return false;
+    const auto &properties = code_action.resolveSupport->properties;
+    return std::find(properties.begin(), properties.end(), "edit") != properties.end();
+}
+
 std::optional<std::vector<std::variant<lsp::data::command, lsp::data::code_action>>>
 sqfvm::language_server::language_server::on_textDocument_codeAction(const lsp::data::code_action_params &params) {
     using namespace lsp::data;
     using namespace database::tables;
-    using namespace std::string_literals;
-    const size_t lsp_trash_offset = 1;
     auto path = std::filesystem::path(
             std::string(params.textDocument.uri.path().begin(),
                         params.textDocument.uri.path().end()))
@@ -437,122 +1014,57 @@ sqfvm::language_server::language_server::on_textDocument_codeAction(const lsp::d
     if (!file_opt.has_value())
         return std::nullopt;
     auto file = file_opt.value();
+    auto defer_edits = client_resolves_code_action_edits();
 
     std::vector<std::variant<lsp::data::command, lsp::data::code_action>> out_data{};
-
-    {
-        // Get code actions and their corresponding changes from database
-        auto code_actions = m_context->storage().get_all<t_code_action>(
-                where(c(&t_code_action::file_fk) == file.id_pk));
-        for (const auto &code_action: code_actions) {
-            std::vector<std::variant<text_document_edit, create_file, rename_file, lsp::data::delete_file>> out_changes{};
-            auto changes = m_context->storage().get_all<t_code_action_change>(
-                    where(c(&t_code_action_change::code_action_fk) == code_action.id_pk));
-            bool in_range = false;
-            for (const auto &change: changes) {
-                in_range = in_range || change.start_line <= params.range.start.line
-                                       && change.start_column <= params.range.start.character
-                                       && change.end_line >= params.range.end.line
-                                       && change.end_column >= params.range.end.character;
-                auto change_path = sanitize_to_uri(change.path);
-                auto document_uri = static_cast<::lsp::data::document_uri>(change_path.full());
-                auto lsp_file_version = m_versions.contains(document_uri)
-                                        ? std::optional<::lsp::data::integer>{m_versions.at(document_uri)}
-                                        : std::nullopt;
-                switch (change.operation) {
-                    case t_code_action_change::file_change:
-                        out_changes.emplace_back(text_document_edit{
-                                .textDocument = optional_versioned_text_document_identifier{
-                                        .version = lsp_file_version,
-                                        .uri = change_path,
-                                },
-                                .edits = {text_edit{
-                                        .range = range{
-                                                .start = position{
-                                                        .line = change.start_line.value_or(0),
-                                                        .character = change.start_column.value_or(0),
-                                                },
-                                                .end = position{
-                                                        .line = change.end_line.value_or(0),
-                                                        .character = change.end_column.value_or(0),
-                                                },
-                                        },
-                                        .new_text = change.content.value_or(""s),
-                                }},
-                        });
-                        break;
-                    case t_code_action_change::file_create:
-                        out_changes.emplace_back(create_file{
-                                .uri = change_path,
-                                .options = create_file::create_file_options{
-                                        .overwrite = true,
-                                        .ignore_if_exists = true,
-                                },
-                        });
-                        out_changes.emplace_back(text_document_edit{
-                                .textDocument = optional_versioned_text_document_identifier{
-                                        .version = lsp_file_version,
-                                        .uri = change_path,
-                                },
-                                .edits = {text_edit{
-                                        .range = range{
-                                                .start = position{0, 0},
-                                                .end = position{0, 0},
-                                        },
-                                        .new_text = change.content.value_or(""s),
-                                }},
-                        });
-                        break;
-                    case t_code_action_change::file_delete:
-                        out_changes.emplace_back(lsp::data::delete_file{
-                                .uri = change_path,
-                                .options = lsp::data::delete_file::delete_file_options{
-                                        .recursive = true,
-                                        .ignore_if_not_exists = true,
-                                },
-                        });
-                        break;
-                    case t_code_action_change::file_rename:
-                        out_changes.emplace_back(rename_file{
-                                .oldUri = sanitize_to_uri(change.old_path.value_or(""s)),
-                                .newUri = change_path,
-                                .options = rename_file::rename_file_options{
-                                        .overwrite = true,
-                                        .ignore_if_exists = true,
-                                },
-                        });
-                        break;
-                }
-            }
-            if (out_changes.empty() || !in_range)
-                continue;
-            out_data.push_back(lsp::data::code_action{
-                    .title = code_action.text,
-                    .kind = code_action.kind == database::tables::t_code_action::quick_fix
-                            ? code_action_kind::QuickFix
-                            : code_action.kind == database::tables::t_code_action::refactor
-                              ? code_action_kind::Refactor
-                              : code_action.kind == database::tables::t_code_action::extract_refactor
-                                ? code_action_kind::RefactorExtract
-                                : code_action.kind == database::tables::t_code_action::inline_refactor
-                                  ? code_action_kind::RefactorInline
-                                  : code_action.kind == database::tables::t_code_action::whole_file
-                                    ? code_action_kind::Source
-                                    : code_action.kind == database::tables::t_code_action::rewrite_refactor
-                                      ? code_action_kind::RefactorRewrite
-                                      : code_action_kind::Empty,
-                    .isPreferred = true,
-                    .edit = workspace_edit{
-                            .changes = {},
-                            .document_changes = out_changes,
-                            .change_annotations = {},
-                    },
-            });
+    for (const auto &[code_action, changes]: m_symbol_index.code_actions_in_range(
+            file.id_pk,
+            params.range.start.line,
+            params.range.start.character,
+            params.range.end.line,
+            params.range.end.character)) {
+        lsp::data::code_action out{
+                .title = code_action.text,
+                .kind = code_action.kind == t_code_action::quick_fix
+                        ? code_action_kind::QuickFix
+                        : code_action.kind == t_code_action::refactor
+                          ? code_action_kind::Refactor
+                          : code_action.kind == t_code_action::extract_refactor
+                            ? code_action_kind::RefactorExtract
+                            : code_action.kind == t_code_action::inline_refactor
+                              ? code_action_kind::RefactorInline
+                              : code_action.kind == t_code_action::whole_file
+                                ? code_action_kind::Source
+                                : code_action.kind == t_code_action::rewrite_refactor
+                                  ? code_action_kind::RefactorRewrite
+                                  : code_action_kind::Empty,
+                .isPreferred = true,
+        };
+        // The edit is only built once the client picks the action
+        if (defer_edits) {
+            out.data = nlohmann::json{{"fileId", file.id_pk}, {"codeActionId", code_action.id_pk}};
+        } else {
+            out.edit = code_action_edit(changes);
         }
+        out_data.emplace_back(std::move(out));
     }
     return {out_data};
 }
 
+lsp::data::code_action
+sqfvm::language_server::language_server::on_codeAction_resolve(const lsp::data::code_action &params) {
+    auto result = params;
+    if (!params.data.has_value() || !params.data->is_object()
+        || !params.data->contains("fileId") || !params.data->contains("codeActionId"))
+        return result;
+    auto code_action = m_symbol_index.code_action(
+            params.data->at("fileId").get<uint64_t>(),
+            params.data->at("codeActionId").get<uint64_t>());
+    if (code_action.has_value())
+        result.edit = code_action_edit(code_action->changes);
+    return result;
+}
+
 std::optional<lsp::data::hover> sqfvm::language_server::language_server::on_textDocument_hover(
         const lsp::data::hover_params &params) {
     using namespace ::lsp::data;
@@ -566,55 +1078,24 @@ std::optional<lsp::data::hover> sqfvm::language_server::language_server::on_text
     if (!file_opt.has_value())
         return std::nullopt;
     auto file = file_opt.value();
-    auto hovers = m_context->storage().get_all<database::tables::t_hover>(
-            where(c(&database::tables::t_hover::file_fk) == file.id_pk
-                  && c(&database::tables::t_hover::start_line) <= params.position.line + 1
-                  && c(&database::tables::t_hover::start_column) <= params.position.character + 1
-                  && c(&database::tables::t_hover::end_line) >= params.position.line + 1
-                  && c(&database::tables::t_hover::end_column) >= params.position.character + 1));
-    if (hovers.empty())
+    auto result = m_symbol_index.innermost_hover_at(
+            file.id_pk,
+            params.position.line + 1,
+            params.position.character + 1);
+    if (!result.has_value())
         return std::nullopt;
-
-    std::vector<hover> out_hovers;
-    for (const auto &hover: hovers) {
-        out_hovers.emplace_back(
-                markup_content{markup_kind::Markdown, hover.markdown},
-                range{
-                        .start = position{
-                                .line = hover.start_line,
-                                .character = hover.start_column,
-                        },
-                        .end = position{
-                                .line = hover.end_line,
-                                .character = hover.end_column,
-                        },
-                });
-    }
-
-    if (out_hovers.size() == 1)
-        return out_hovers.front();
-
-    std::stringstream sstream;
-    position smallest_start = out_hovers.front().range->start;
-    position largest_end = out_hovers.front().range->end;
-
-    for (const auto &hover: out_hovers) {
-        if (hover.range->start.line < smallest_start.line ||
-            (hover.range->start.line == smallest_start.line && hover.range->start.character < smallest_start.character))
-            smallest_start = hover.range->start;
-        if (hover.range->end.line > largest_end.line ||
-            (hover.range->end.line == largest_end.line && hover.range->end.character > largest_end.character))
-            largest_end = hover.range->end;
-        if (sstream.tellp() > 0)
-            sstream << "\n\n";
-        sstream << hover.contents.value;
-    }
-
-    return hover{
-            .contents = markup_content{markup_kind::Markdown, sstream.str()},
+    const auto &[hover, markdown] = result.value();
+    return ::lsp::data::hover{
+            .contents = markup_content{markup_kind::Markdown, markdown},
             .range = range{
-                    .start = smallest_start,
-                    .end = largest_end,
+                    .start = position{
+                            .line = hover.start_line,
+                            .character = hover.start_column,
+                    },
+                    .end = position{
+                            .line = hover.end_line,
+                            .character = hover.end_column,
+                    },
             },
     };
 }
@@ -181,6 +181,104 @@ nlohmann::json lsp::data::references_params::to_json() const {
     return json;
 }
 
+lsp::data::definition_params lsp::data::definition_params::from_json(const nlohmann::json &node) {
+    definition_params res;
+    data::from_json(node, "partialResultToken", res.partialResultToken);
+    data::from_json(node, "workDoneToken", res.workDoneToken);
+    data::from_json(node, "textDocument", res.textDocument);
+    data::from_json(node, "position", res.position);
+    return res;
+}
+
+nlohmann::json lsp::data::definition_params::to_json() const {
+    nlohmann::json json;
+    data::set_json(json, "partialResultToken", partialResultToken);
+    data::set_json(json, "workDoneToken", workDoneToken);
+    data::set_json(json, "textDocument", textDocument);
+    data::set_json(json, "position", position);
+    return json;
+}
+
+lsp::data::semantic_tokens_params lsp::data::semantic_tokens_params::from_json(const nlohmann::json &node) {
+    semantic_tokens_params res;
+    data::from_json(node, "partialResultToken", res.partialResultToken);
+    data::from_json(node, "workDoneToken", res.workDoneToken);
+    data::from_json(node, "textDocument", res.textDocument);
+    return res;
+}
+
+nlohmann::json lsp::data::semantic_tokens_params::to_json() const {
+    nlohmann::json json;
+    data::set_json(json, "partialResultToken", partialResultToken);
+    data::set_json(json, "workDoneToken", workDoneToken);
+    data::set_json(json, "textDocument", textDocument);
+    return json;
+}
+
+lsp::data::semantic_tokens_delta_params
+lsp::data::semantic_tokens_delta_params::from_json(const nlohmann::json &node) {
+    semantic_tokens_delta_params res;
+    data::from_json(node, "partialResultToken", res.partialResultToken);
+    data::from_json(node, "workDoneToken", res.workDoneToken);
+    data::from_json(node, "textDocument", res.textDocument);
+    data::from_json(node, "previousResultId", res.previousResultId);
+    return res;
+}
+
+nlohmann::json lsp::data::semantic_tokens_delta_params::to_json() const {
+    nlohmann::json json;
+    data::set_json(json, "partialResultToken", partialResultToken);
+    data::set_json(json, "workDoneToken", workDoneToken);
+    data::set_json(json, "textDocument", textDocument);
+    data::set_json(json, "previousResultId", previousResultId);
+    return json;
+}
+
+lsp::data::semantic_tokens lsp::data::semantic_tokens::from_json(const nlohmann::json &node) {
+    semantic_tokens res;
+    data::from_json(node, "resultId", res.resultId);
+    data::from_json(node, "data", res.data);
+    return res;
+}
+
+nlohmann::json lsp::data::semantic_tokens::to_json() const {
+    nlohmann::json json;
+    data::set_json(json, "resultId", resultId);
+    data::set_json(json, "data", data);
+    return json;
+}
+
+lsp::data::semantic_tokens_delta::semantic_tokens_edit
+lsp::data::semantic_tokens_delta::semantic_tokens_edit::from_json(const nlohmann::json &node) {
+    semantic_tokens_edit res{};
+    data::from_json(node, "start", res.start);
+    data::from_json(node, "deleteCount", res.deleteCount);
+    data::from_json(node, "data", res.data);
+    return res;
+}
+
+nlohmann::json lsp::data::semantic_tokens_delta::semantic_tokens_edit::to_json() const {
+    nlohmann::json json;
+    data::set_json(json, "start", start);
+    data::set_json(json, "deleteCount", deleteCount);
+    data::set_json(json, "data", data);
+    return json;
+}
+
+lsp::data::semantic_tokens_delta lsp::data::semantic_tokens_delta::from_json(const nlohmann::json &node) {
+    semantic_tokens_delta res;
+    data::from_json(node, "resultId", res.resultId);
+    data::from_json(node, "edits", res.edits);
+    return res;
+}
+
+nlohmann::json lsp::data::semantic_tokens_delta::to_json() const {
+    nlohmann::json json;
+    data::set_json(json, "resultId", resultId);
+    data::set_json(json, "edits", edits);
+    return json;
+}
+
 nlohmann::json lsp::data::references_params::ReferenceContext::to_json() const {
     nlohmann::json json;
     data::set_json(json, "includeDeclaration", includeDeclaration);
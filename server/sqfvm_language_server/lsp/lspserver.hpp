@@ -918,6 +918,50 @@ namespace lsp::data {
         }
     };
 
+    /**
+     * Represents information about programming constructs like variables, classes,
+     * interfaces etc.
+     */
+    struct symbol_information {
+        /**
+         * The name of this symbol.
+         */
+        std::string name;
+        /**
+         * The kind of this symbol.
+         */
+        symbol_kind kind{};
+        /**
+         * The location of this symbol.
+         */
+        data::location location;
+        /**
+         * The name of the symbol containing this symbol. This information is for
+         * user interface purposes (e.g. to render a qualifier in the user interface
+         * if necessary). It can't be used to re-infer a hierarchy for the document
+         * symbols.
+         */
+        std::optional<std::string> containerName;
+
+        static symbol_information from_json(const nlohmann::json &node) {
+            symbol_information res;
+            data::from_json(node, "name", res.name);
+            data::from_json(node, "kind", res.kind);
+            data::from_json(node, "location", res.location);
+            data::from_json(node, "containerName", res.containerName);
+            return res;
+        }
+
+        [[nodiscard]] nlohmann::json to_json() const {
+            nlohmann::json json;
+            data::set_json(json, "name", name);
+            data::set_json(json, "kind", kind);
+            data::set_json(json, "location", location);
+            data::set_json(json, "containerName", containerName);
+            return json;
+        }
+    };
+
     /**
      * Represents a reference to a command.
      * Provides a title which will be used to represent a command in the UI.
@@ -1663,20 +1707,21 @@ namespace lsp::data {
              */
         std::optional<nlohmann::json> data;
 
-        // implementing generic std::variant support is hard and implementing type-specific from_json is not worth
-        // it here as it is server-only anyway.
-        // static code_action from_json(const nlohmann::json &node) {
-        //     code_action res;
-        //     data::from_json(node, "title", res.title);
-        //     data::from_json(node, "kind", res.kind);
-        //     data::from_json(node, "diagnostics", res.diagnostics);
-        //     data::from_json(node, "isPreferred", res.isPreferred);
-        //     data::from_json(node, "disabled", res.disabled);
-        //     data::from_json(node, "edit", res.edit);
-        //     data::from_json(node, "command", res.command);
-        //     data::from_json(node, "data", res.data);
-        //     return res;
-        // }
+        // implementing generic std::variant support is hard, hence the edit is not read back. Clients only send
+        // code actions for `codeAction/resolve`, which is where the edit gets computed.
+        static code_action from_json(const nlohmann::json &node) {
+            code_action res;
+            data::from_json(node, "title", res.title);
+            data::from_json(node, "kind", res.kind);
+            data::from_json(node, "diagnostics", res.diagnostics);
+            data::from_json(node, "isPreferred", res.isPreferred);
+            data::from_json(node, "disabled", res.disabled);
+            data::from_json(node, "command", res.command);
+            if (node.contains("data")) {
+                res.data = node["data"];
+            }
+            return res;
+        }
 
         [[nodiscard]] nlohmann::json to_json() const {
             nlohmann::json json;
@@ -2045,6 +2090,86 @@ namespace lsp::data {
                 }
             };
 
+            struct semantic_tokens_options {
+                struct semantic_tokens_legend {
+                    /**
+                     * The token types a server uses.
+                     */
+                    std::vector<std::string> tokenTypes;
+                    /**
+                     * The token modifiers a server uses.
+                     */
+                    std::vector<std::string> tokenModifiers;
+
+                    static semantic_tokens_legend from_json(const nlohmann::json &node) {
+                        semantic_tokens_legend res;
+                        data::from_json(node, "tokenTypes", res.tokenTypes);
+                        data::from_json(node, "tokenModifiers", res.tokenModifiers);
+                        return res;
+                    }
+
+                    nlohmann::json to_json() const {
+                        nlohmann::json json;
+                        data::set_json(json, "tokenTypes", tokenTypes);
+                        data::set_json(json, "tokenModifiers", tokenModifiers);
+                        return json;
+                    }
+                };
+                struct semantic_tokens_full_options {
+                    /**
+                     * The server supports deltas for full documents.
+                     */
+                    std::optional<bool> delta;
+
+                    static semantic_tokens_full_options from_json(const nlohmann::json &node) {
+                        semantic_tokens_full_options res;
+                        data::from_json(node, "delta", res.delta);
+                        return res;
+                    }
+
+                    nlohmann::json to_json() const {
+                        nlohmann::json json;
+                        data::set_json(json, "delta", delta);
+                        return json;
+                    }
+                };
+                std::optional<bool> workDoneProgress;
+                /**
+                 * The legend used by the server
+                 */
+                semantic_tokens_legend legend;
+                /**
+                 * Server supports providing semantic tokens for a specific range
+                 * of a document.
+                 */
+                std::optional<bool> range;
+                /**
+                 * Server supports providing semantic tokens for a full document.
+                 *
+                 * Implementors note: Technically, this should support `boolean | { delta?: boolean }` ... but we ignore that simply because
+                 *                    the object form covers both.
+                 */
+                std::optional<semantic_tokens_full_options> full;
+
+                static semantic_tokens_options from_json(const nlohmann::json &node) {
+                    semantic_tokens_options res;
+                    data::from_json(node, "workDoneProgress", res.workDoneProgress);
+                    data::from_json(node, "legend", res.legend);
+                    data::from_json(node, "range", res.range);
+                    data::from_json(node, "full", res.full);
+                    return res;
+                }
+
+                nlohmann::json to_json() const {
+                    nlohmann::json json;
+                    data::set_json(json, "workDoneProgress", workDoneProgress);
+                    data::set_json(json, "legend", legend);
+                    data::set_json(json, "range", range);
+                    data::set_json(json, "full", full);
+                    return json;
+                }
+            };
+
             struct signature_help_options {
                 std::optional<bool> workDoneProgress;
                 /**
@@ -2243,11 +2368,19 @@ namespace lsp::data {
                         * may list out every specific kind they provide.
                         */
                 std::optional<std::vector<code_action_kind>> codeActionKinds;
+                /**
+                        * The server provides support to resolve additional
+                        * information for a code action.
+                        *
+                        * @since 3.16.0
+                        */
+                std::optional<bool> resolveProvider;
 
                 static code_action_options from_json(const nlohmann::json &node) {
                     code_action_options res;
                     data::from_json(node, "workDoneProgress", res.workDoneProgress);
                     data::from_json(node, "codeActionKinds", res.codeActionKinds);
+                    data::from_json(node, "resolveProvider", res.resolveProvider);
                     return res;
                 }
 
@@ -2255,6 +2388,7 @@ namespace lsp::data {
                     nlohmann::json json;
                     data::set_json(json, "workDoneProgress", workDoneProgress);
                     data::set_json(json, "codeActionKinds", codeActionKinds);
+                    data::set_json(json, "resolveProvider", resolveProvider);
                     return json;
                 }
             };
@@ -2581,6 +2715,13 @@ namespace lsp::data {
              */
             std::optional<inlay_hint_options> inlayHintProvider;
 
+            /**
+             * The server provides semantic tokens support.
+             *
+             * @since 3.16.0
+             */
+            std::optional<semantic_tokens_options> semanticTokensProvider;
+
             /**
                     * The server provides signature help support.
                     */
@@ -2789,6 +2930,7 @@ namespace lsp::data {
                 data::from_json(node, "selectionRangeProvider", res.selectionRangeProvider);
                 data::from_json(node, "workspaceSymbolProvider", res.workspaceSymbolProvider);
                 data::from_json(node, "inlayHintProvider", res.inlayHintProvider);
+                data::from_json(node, "semanticTokensProvider", res.semanticTokensProvider);
                 data::from_json(node, "workspace", res.workspace);
                 res.experimental = node.contains("experimental") ? node["experimental"] : nlohmann::json(nullptr);
                 return res;
@@ -2820,6 +2962,7 @@ namespace lsp::data {
                 data::set_json(json, "selectionRangeProvider", selectionRangeProvider);
                 data::set_json(json, "workspaceSymbolProvider", workspaceSymbolProvider);
                 data::set_json(json, "inlayHintProvider", inlayHintProvider);
+                data::set_json(json, "semanticTokensProvider", semanticTokensProvider);
                 data::set_json(json, "workspace", workspace);
                 if (experimental.has_value()) {
                     json["experimental"] = *experimental;
@@ -3597,11 +3740,49 @@ namespace lsp::data {
                     */
             std::optional<bool> isPreferredSupport;
 
+            /**
+                    * Whether code action supports the `data` property which is
+                    * preserved between a `textDocument/codeAction` and a
+                    * `codeAction/resolve` request.
+                    *
+                    * @since 3.16.0
+                    */
+            std::optional<bool> dataSupport;
+
+            struct ResolveSupport {
+                /**
+                        * The properties that a client can resolve lazily.
+                        */
+                std::vector<std::string> properties;
+
+                static ResolveSupport from_json(const nlohmann::json &node) {
+                    ResolveSupport res;
+                    data::from_json(node, "properties", res.properties);
+                    return res;
+                }
+
+                nlohmann::json to_json() const {
+                    nlohmann::json json;
+                    data::set_json(json, "properties", properties);
+                    return json;
+                }
+            };
+
+            /**
+                    * Whether the client supports resolving additional code action
+                    * properties via a separate `codeAction/resolve` request.
+                    *
+                    * @since 3.16.0
+                    */
+            std::optional<ResolveSupport> resolveSupport;
+
             static code_action_client_capabilities from_json(const nlohmann::json &node) {
                 code_action_client_capabilities res;
                 data::from_json(node, "dynamicRegistration", res.dynamicRegistration);
                 data::from_json(node, "codeActionLiteralSupport", res.codeActionLiteralSupport);
                 data::from_json(node, "isPreferredSupport", res.isPreferredSupport);
+                data::from_json(node, "dataSupport", res.dataSupport);
+                data::from_json(node, "resolveSupport", res.resolveSupport);
                 return res;
             }
 
@@ -3610,6 +3791,8 @@ namespace lsp::data {
                 data::set_json(json, "dynamicRegistration", dynamicRegistration);
                 data::set_json(json, "codeActionLiteralSupport", codeActionLiteralSupport);
                 data::set_json(json, "isPreferredSupport", isPreferredSupport);
+                data::set_json(json, "dataSupport", dataSupport);
+                data::set_json(json, "resolveSupport", resolveSupport);
                 return json;
             }
         };
@@ -4428,6 +4611,71 @@ namespace lsp::data {
         }
     };
 
+    struct workspace_symbol_params {
+        /**
+        * An optional token that a server can use to report partial results (e.g. streaming) to
+        * the client.
+        */
+        std::optional<std::string> partialResultToken;
+        /**
+        * An optional token that a server can use to report work done progress.
+        */
+        std::optional<std::string> workDoneToken;
+        /**
+        * A query string to filter symbols by. Clients may send an empty
+        * string here to request all symbols.
+        */
+        std::string query;
+
+        static workspace_symbol_params from_json(const nlohmann::json &node) {
+            workspace_symbol_params res;
+            data::from_json(node, "partialResultToken", res.partialResultToken);
+            data::from_json(node, "workDoneToken", res.workDoneToken);
+            data::from_json(node, "query", res.query);
+            return res;
+        }
+
+        nlohmann::json to_json() const {
+            nlohmann::json json;
+            data::set_json(json, "partialResultToken", partialResultToken);
+            data::set_json(json, "workDoneToken", workDoneToken);
+            data::set_json(json, "query", query);
+            return json;
+        }
+    };
+
+    struct document_symbol_params {
+        /**
+        * An optional token that a server can use to report partial results (e.g. streaming) to
+        * the client.
+        */
+        std::optional<std::string> partialResultToken;
+        /**
+        * An optional token that a server can use to report work done progress.
+        */
+        std::optional<std::string> workDoneToken;
+        /**
+        * The text document.
+        */
+        text_document_identifier textDocument;
+
+        static document_symbol_params from_json(const nlohmann::json &node) {
+            document_symbol_params res;
+            data::from_json(node, "partialResultToken", res.partialResultToken);
+            data::from_json(node, "workDoneToken", res.workDoneToken);
+            data::from_json(node, "textDocument", res.textDocument);
+            return res;
+        }
+
+        nlohmann::json to_json() const {
+            nlohmann::json json;
+            data::set_json(json, "partialResultToken", partialResultToken);
+            data::set_json(json, "workDoneToken", workDoneToken);
+            data::set_json(json, "textDocument", textDocument);
+            return json;
+        }
+    };
+
     struct did_close_text_document_params {
         /**
         * The document that was closed.
@@ -4709,6 +4957,129 @@ namespace lsp::data {
         [[nodiscard]] nlohmann::json to_json() const;
     };
 
+    struct definition_params {
+        /**
+            * An optional token that a server can use to report partial results (e.g. streaming) to
+            * the client.
+            */
+        std::optional<std::string> partialResultToken;
+        /**
+            * An optional token that a server can use to report work done progress.
+            */
+        std::optional<std::string> workDoneToken;
+        /**
+            * The text document.
+            */
+        text_document_identifier textDocument;
+
+        /**
+            * The position inside the text document.
+            */
+        position position{};
+
+        [[nodiscard]] static definition_params from_json(const nlohmann::json &node);
+
+        [[nodiscard]] nlohmann::json to_json() const;
+    };
+
+    // DeclarationParams carry the very same properties as DefinitionParams.
+    using declaration_params = definition_params;
+
+    struct semantic_tokens_params {
+        /**
+            * An optional token that a server can use to report partial results (e.g. streaming) to
+            * the client.
+            */
+        std::optional<std::string> partialResultToken;
+        /**
+            * An optional token that a server can use to report work done progress.
+            */
+        std::optional<std::string> workDoneToken;
+        /**
+            * The text document.
+            */
+        text_document_identifier textDocument;
+
+        [[nodiscard]] static semantic_tokens_params from_json(const nlohmann::json &node);
+
+        [[nodiscard]] nlohmann::json to_json() const;
+    };
+
+    struct semantic_tokens_delta_params {
+        /**
+            * An optional token that a server can use to report partial results (e.g. streaming) to
+            * the client.
+            */
+        std::optional<std::string> partialResultToken;
+        /**
+            * An optional token that a server can use to report work done progress.
+            */
+        std::optional<std::string> workDoneToken;
+        /**
+            * The text document.
+            */
+        text_document_identifier textDocument;
+        /**
+            * The result id of a previous response. The result Id can either point to
+            * a full response or a delta response depending on what was received last.
+            */
+        std::string previousResultId;
+
+        [[nodiscard]] static semantic_tokens_delta_params from_json(const nlohmann::json &node);
+
+        [[nodiscard]] nlohmann::json to_json() const;
+    };
+
+    struct semantic_tokens {
+        /**
+            * An optional result id. If provided and clients support delta updating
+            * the client will include the result id in the next semantic token request.
+            * A server can then instead of computing all semantic tokens again simply
+            * send a delta.
+            */
+        std::optional<std::string> resultId;
+        /**
+            * The actual tokens, five integers per token: deltaLine, deltaStartChar, length,
+            * tokenType and tokenModifiers.
+            */
+        std::vector<uint32_t> data;
+
+        [[nodiscard]] static semantic_tokens from_json(const nlohmann::json &node);
+
+        [[nodiscard]] nlohmann::json to_json() const;
+    };
+
+    struct semantic_tokens_delta {
+        struct semantic_tokens_edit {
+            /**
+                * The start offset of the edit.
+                */
+            uint32_t start;
+            /**
+                * The count of elements to remove.
+                */
+            uint32_t deleteCount;
+            /**
+                * The elements to insert.
+                */
+            std::optional<std::vector<uint32_t>> data;
+
+            [[nodiscard]] static semantic_tokens_edit from_json(const nlohmann::json &node);
+
+            [[nodiscard]] nlohmann::json to_json() const;
+        };
+
+        std::optional<std::string> resultId;
+        /**
+            * The semantic token edits to transform a previous result into a new result.
+            */
+        std::vector<semantic_tokens_edit> edits;
+
+        [[nodiscard]] static semantic_tokens_delta from_json(const nlohmann::json &node);
+
+        [[nodiscard]] nlohmann::json to_json() const;
+    };
+
     struct inlay_hint_params {
         /**
         * An optional token that a server can use to report work done progress.
@@ -111,6 +111,19 @@ void lsp::server::register_methods() {
                     window_logMessage(data::message_type::Log, sstream.str());
                 }
             });
+    m_rpc.register_method(
+            "completionItem/resolve", [&](jsonrpc &rpc, const jsonrpc::rpcmessage &msg) {
+                try {
+                    auto params = data::completion_item::from_json(msg.params.value());
+                    auto res = on_completionItem_resolve(params);
+                    rpc.send({msg.id, res.to_json()});
+                }
+                catch (const std::exception &e) {
+                    std::stringstream sstream;
+                    sstream << "rpc call 'completionItem/resolve' failed with: '" << e.what() << "'.";
+                    window_logMessage(data::message_type::Log, sstream.str());
+                }
+            });
     m_rpc.register_method(
             "textDocument/foldingRange", [&](jsonrpc &rpc, const jsonrpc::rpcmessage &msg) {
                 try {
@@ -150,6 +163,84 @@ void lsp::server::register_methods() {
                     window_logMessage(data::message_type::Log, sstream.str());
                 }
             });
+    m_rpc.register_method(
+            "textDocument/semanticTokens/full", [&](jsonrpc &rpc, const jsonrpc::rpcmessage &msg) {
+                try {
+                    auto params = data::semantic_tokens_params::from_json(msg.params.value());
+                    auto res = on_textDocument_semanticTokens_full(params);
+                    rpc.send({msg.id, to_json(res)});
+                }
+                catch (const std::exception &e) {
+                    std::stringstream sstream;
+                    sstream << "rpc call 'textDocument/semanticTokens/full' failed with: '" << e.what() << "'.";
+                    window_logMessage(data::message_type::Log, sstream.str());
+                }
+            });
+    m_rpc.register_method(
+            "textDocument/semanticTokens/full/delta", [&](jsonrpc &rpc, const jsonrpc::rpcmessage &msg) {
+                try {
+                    auto params = data::semantic_tokens_delta_params::from_json(msg.params.value());
+                    auto res = on_textDocument_semanticTokens_full_delta(params);
+                    rpc.send({msg.id, to_json(res)});
+                }
+                catch (const std::exception &e) {
+                    std::stringstream sstream;
+                    sstream << "rpc call 'textDocument/semanticTokens/full/delta' failed with: '" << e.what() << "'.";
+                    window_logMessage(data::message_type::Log, sstream.str());
+                }
+            });
+    m_rpc.register_method(
+            "textDocument/definition", [&](jsonrpc &rpc, const jsonrpc::rpcmessage &msg) {
+                try {
+                    auto params = data::definition_params::from_json(msg.params.value());
+                    auto res = on_textDocument_definition(params);
+                    rpc.send({msg.id, to_json(res)});
+                }
+                catch (const std::exception &e) {
+                    std::stringstream sstream;
+                    sstream << "rpc call 'textDocument/definition' failed with: '" << e.what() << "'.";
+                    window_logMessage(data::message_type::Log, sstream.str());
+                }
+            });
+    m_rpc.register_method(
+            "textDocument/declaration", [&](jsonrpc &rpc, const jsonrpc::rpcmessage &msg) {
+                try {
+                    auto params = data::declaration_params::from_json(msg.params.value());
+                    auto res = on_textDocument_declaration(params);
+                    rpc.send({msg.id, to_json(res)});
+                }
+                catch (const std::exception &e) {
+                    std::stringstream sstream;
+                    sstream << "rpc call 'textDocument/declaration' failed with: '" << e.what() << "'.";
+                    window_logMessage(data::message_type::Log, sstream.str());
+                }
+            });
+    m_rpc.register_method(
+            "textDocument/documentSymbol", [&](jsonrpc &rpc, const jsonrpc::rpcmessage &msg) {
+                try {
+                    auto params = data::document_symbol_params::from_json(msg.params.value());
+                    auto res = on_textDocument_documentSymbol(params);
+                    rpc.send({msg.id, to_json(res)});
+                }
+                catch (const std::exception &e) {
+                    std::stringstream sstream;
+                    sstream << "rpc call 'textDocument/documentSymbol' failed with: '" << e.what() << "'.";
+                    window_logMessage(data::message_type::Log, sstream.str());
+                }
+            });
+    m_rpc.register_method(
+            "workspace/symbol", [&](jsonrpc &rpc, const jsonrpc::rpcmessage &msg) {
+                try {
+                    auto params = data::workspace_symbol_params::from_json(msg.params.value());
+                    auto res = on_workspace_symbol(params);
+                    rpc.send({msg.id, to_json(res)});
+                }
+                catch (const std::exception &e) {
+                    std::stringstream sstream;
+                    sstream << "rpc call 'workspace/symbol' failed with: '" << e.what() << "'.";
+                    window_logMessage(data::message_type::Log, sstream.str());
+                }
+            });
     m_rpc.register_method(
             "textDocument/colorPresentation", [&](jsonrpc &rpc, const jsonrpc::rpcmessage &msg) {
                 try {
@@ -176,6 +267,19 @@ void lsp::server::register_methods() {
                     window_logMessage(data::message_type::Log, sstream.str());
                 }
             });
+    m_rpc.register_method(
+            "codeAction/resolve", [&](jsonrpc &rpc, const jsonrpc::rpcmessage &msg) {
+                try {
+                    auto params = data::code_action::from_json(msg.params.value());
+                    auto res = on_codeAction_resolve(params);
+                    rpc.send({msg.id, res.to_json()});
+                }
+                catch (const std::exception &e) {
+                    std::stringstream sstream;
+                    sstream << "rpc call 'codeAction/resolve' failed with: '" << e.what() << "'.";
+                    window_logMessage(data::message_type::Log, sstream.str());
+                }
+            });
     m_rpc.register_method(
             "textDocument/hover", [&](jsonrpc &rpc, const jsonrpc::rpcmessage &msg) {
                 try {
@@ -217,11 +321,15 @@ void lsp::server::register_methods() {
 }
 
 void lsp::server::listen() {
+    auto last_message = std::chrono::steady_clock::now();
     while (!m_die) {
         if (!m_rpc.handle_single_message()) {
+            on_idle(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - last_message));
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
             continue;
         }
+        last_message = std::chrono::steady_clock::now();
     }
 }
 
@@ -13,6 +13,7 @@
 #include "jsonrpc.hpp"
 #include "../uri.hpp"
 
+#include <chrono>
 #include <optional>
 #include <string>
 #include <nlohmann/json.hpp>
@@ -71,6 +72,10 @@ namespace lsp {
             return {};
         }
 
+        virtual lsp::data::completion_item on_completionItem_resolve(const lsp::data::completion_item &params) {
+            return params;
+        }
+
         virtual std::optional<lsp::data::hover> on_textDocument_hover(
                 const lsp::data::hover_params &params) {
             return {};
@@ -103,15 +108,53 @@ namespace lsp {
             return {};
         }
 
+        virtual lsp::data::code_action on_codeAction_resolve(const lsp::data::code_action &params) {
+            return params;
+        }
+
         virtual std::optional<std::vector<lsp::data::location>> on_textDocument_references(
                 const lsp::data::references_params &params) {
             return {};
         }
 
+        virtual std::optional<lsp::data::semantic_tokens> on_textDocument_semanticTokens_full(
+                const lsp::data::semantic_tokens_params &params) {
+            return {};
+        }
+
+        virtual std::optional<std::variant<lsp::data::semantic_tokens, lsp::data::semantic_tokens_delta>>
+        on_textDocument_semanticTokens_full_delta(const lsp::data::semantic_tokens_delta_params &params) {
+            return {};
+        }
+
+        virtual std::optional<std::vector<lsp::data::location>> on_textDocument_definition(
+                const lsp::data::definition_params &params) {
+            return {};
+        }
+
+        virtual std::optional<std::vector<lsp::data::location>> on_textDocument_declaration(
+                const lsp::data::declaration_params &params) {
+            return {};
+        }
+
+        virtual std::optional<std::vector<lsp::data::symbol_information>> on_textDocument_documentSymbol(
+                const lsp::data::document_symbol_params &params) {
+            return {};
+        }
+
+        virtual std::optional<std::vector<lsp::data::symbol_information>> on_workspace_symbol(
+                const lsp::data::workspace_symbol_params &params) {
+            return {};
+        }
+
         virtual void on_workspace_didChangeConfiguration(
                 const lsp::data::did_change_configuration_params &params) {
         }
 
+        // Called repeatedly from listen() while no message is pending.
+        // idle_time is the time passed since the last message was handled.
+        virtual void on_idle(std::chrono::milliseconds idle_time) { /* empty */ }
+
     public:
         void textDocument_publishDiagnostics(const lsp::data::publish_diagnostics_params &params) {
             m_rpc.send({{}, "textDocument/publishDiagnostics", params.to_json()});
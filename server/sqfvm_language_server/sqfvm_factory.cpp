@@ -9,6 +9,9 @@
 
 
 void sqfvm::language_server::sqfvm_factory::log_to_window(const LogMessageBase &msg) const {
+    // Factories created without a language server (eg. by the benchmark) have no window to log to
+    if (m_language_server == nullptr)
+        return;
     auto level = msg.getLevel();
     ::lsp::data::message_type message_type;
     switch (level) {